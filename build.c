@@ -40,15 +40,26 @@ int main(int argc, char **argv)
     nob_cmd_append(&cmd,
         SRC_FOLDER"/main.c",
         SRC_FOLDER"/des.c",
+        SRC_FOLDER"/desBitslice.c",
         SRC_FOLDER"/desModes.c",
+        SRC_FOLDER"/threadPool.c",
         SRC_FOLDER"/utils.c",
         SRC_FOLDER"/rsa.c",
         SRC_FOLDER"/rsaKeygen.c",
+        SRC_FOLDER"/montgomery.c",
+        SRC_FOLDER"/rsaBatch.c",
+        SRC_FOLDER"/rsaService.c",
         SRC_FOLDER"/evoting.c",
-        SRC_FOLDER"/sha256.c"
+        SRC_FOLDER"/sha256.c",
+        SRC_FOLDER"/sha256Multi.c",
+        SRC_FOLDER"/sha512.c",
+        SRC_FOLDER"/blake3.c",
+        SRC_FOLDER"/hash.c",
+        SRC_FOLDER"/hmac.c",
+        SRC_FOLDER"/sha256Tree.c"
     );
-    // link with gmp lib
-    nob_cmd_append(&cmd, "-lgmp");
+    // link with gmp lib, and pthreads for the worker pool
+    nob_cmd_append(&cmd, "-lgmp", "-pthread");
 #else
     // MSVC build command
     nob_cmd_append(&cmd, "cl");
@@ -57,12 +68,23 @@ int main(int argc, char **argv)
     nob_cmd_append(&cmd,
         SRC_FOLDER"/main.c",
         SRC_FOLDER"/des.c",
+        SRC_FOLDER"/desBitslice.c",
         SRC_FOLDER"/desModes.c",
+        SRC_FOLDER"/threadPool.c",
         SRC_FOLDER"/utils.c",
         SRC_FOLDER"/rsa.c",
         SRC_FOLDER"/rsaKeygen.c",
+        SRC_FOLDER"/montgomery.c",
+        SRC_FOLDER"/rsaBatch.c",
+        SRC_FOLDER"/rsaService.c",
         SRC_FOLDER"/evoting.c",
-        SRC_FOLDER"/sha256.c"
+        SRC_FOLDER"/sha256.c",
+        SRC_FOLDER"/sha256Multi.c",
+        SRC_FOLDER"/sha512.c",
+        SRC_FOLDER"/blake3.c",
+        SRC_FOLDER"/hash.c",
+        SRC_FOLDER"/hmac.c",
+        SRC_FOLDER"/sha256Tree.c"
     );
     // link with gmp lib
     nob_cmd_append(&cmd, "-lgmp");
@@ -75,5 +97,43 @@ int main(int argc, char **argv)
     }
 
     printf("Build successful! Executable is at %s/evoting-system\n", BUILD_FOLDER);
+
+#if !defined(_MSC_VER)
+    // Compile the file signing tool
+    printf("Building file signing tool...\n");
+
+    cmd.count = 0;
+
+    nob_cmd_append(&cmd, "cc");
+    nob_cmd_append(&cmd, "-Wall", "-Wextra");
+    nob_cmd_append(&cmd, "-o", BUILD_FOLDER"/file-sign");
+    nob_cmd_append(&cmd,
+        SRC_FOLDER"/fileSignTool.c",
+        SRC_FOLDER"/fileSign.c",
+        SRC_FOLDER"/utils.c",
+        SRC_FOLDER"/rsa.c",
+        SRC_FOLDER"/rsaKeygen.c",
+        SRC_FOLDER"/montgomery.c",
+        SRC_FOLDER"/sha256.c",
+        SRC_FOLDER"/sha512.c",
+        SRC_FOLDER"/blake3.c",
+        SRC_FOLDER"/hash.c",
+        SRC_FOLDER"/threadPool.c",
+        SRC_FOLDER"/sha256Multi.c",
+        SRC_FOLDER"/sha256Tree.c"
+    );
+    // reader thread of the non mmap fallback, and the BLAKE3 workers
+    nob_cmd_append(&cmd, "-lgmp", "-pthread");
+
+    if (!nob_cmd_run_sync(cmd)) {
+        fprintf(stderr, "ERROR: Build failed\n");
+        return 1;
+    }
+
+    printf("Build successful! Executable is at %s/file-sign\n", BUILD_FOLDER);
+#else
+    // fileSign.c needs mmap, pthreads and unistd, there is no MSVC build of it
+    printf("Skipping file signing tool, it needs a POSIX system\n");
+#endif
     return 0;
 }
\ No newline at end of file
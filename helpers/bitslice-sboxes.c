@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "../src/constants.h"
+
+/*
+    Generates src/desSboxes.h, the bitsliced S-boxes used by src/desBitslice.c
+
+    cc -o helpers/bitslice-sboxes helpers/bitslice-sboxes.c
+    ./helpers/bitslice-sboxes > src/desSboxes.h
+
+    Every boolean function of the 6 S-box inputs fits in a 64 bit truth table, so
+    each output bit is split with shannon expansion (f = x ? f1 : f0) one input at a
+    time. Sub functions are shared between the 4 outputs (same truth table = same
+    gate), and all 720 input orders are tried to keep the one with fewest gates.
+*/
+
+#define MAX_NODES 1024
+
+typedef enum { OP_VAR, OP_NOT, OP_AND, OP_ANDN, OP_OR, OP_XOR } opType;
+
+typedef struct {
+    uint64_t tt;
+    opType op;
+    int a, b;
+} node;
+
+static node nodes[MAX_NODES];
+static int nodeCount;
+static int order[6];
+
+static const uint64_t ALL = ~(uint64_t)0;
+
+// truth table of input a(v+1), bit m of the table is the function value for input m
+static uint64_t varTable(int v) {
+    uint64_t tt = 0;
+
+    for (int m = 0; m < 64; m++) {
+        if ((m >> (5 - v)) & 1) {
+            tt |= (uint64_t)1 << m;
+        }
+    }
+
+    return tt;
+}
+
+static int findNode(uint64_t tt) {
+    for (int i = 0; i < nodeCount; i++) {
+        if (nodes[i].tt == tt) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static int addNode(uint64_t tt, opType op, int a, int b) {
+    int found = findNode(tt);
+
+    if (found >= 0) {
+        return found;
+    }
+
+    nodes[nodeCount].tt = tt;
+    nodes[nodeCount].op = op;
+    nodes[nodeCount].a = a;
+    nodes[nodeCount].b = b;
+
+    return nodeCount++;
+}
+
+// cofactor of tt with input v fixed, still as a function of all 6 inputs
+static uint64_t cofactor(uint64_t tt, int v, int value) {
+    uint64_t x = varTable(v);
+    int shift = 1 << (5 - v);
+
+    if (value) {
+        uint64_t hi = tt & x;
+        return hi | (hi >> shift);
+    }
+
+    uint64_t lo = tt & ~x;
+    return lo | (lo << shift);
+}
+
+// build tt (never constant) splitting on order[depth] onwards
+static int build(uint64_t tt, int depth) {
+    int found = findNode(tt);
+
+    if (found >= 0) {
+        return found;
+    }
+
+    found = findNode(~tt);
+
+    if (found >= 0) {
+        return addNode(tt, OP_NOT, found, 0);
+    }
+
+    int v = order[depth];
+    uint64_t f0 = cofactor(tt, v, 0);
+    uint64_t f1 = cofactor(tt, v, 1);
+
+    if (f0 == f1) {
+        return build(tt, depth + 1);
+    }
+
+    // the inputs are nodes 0..5
+    int x = v;
+
+    if (f0 == 0) {
+        return addNode(tt, OP_AND, x, build(f1, depth + 1));
+    }
+
+    if (f1 == 0) {
+        return addNode(tt, OP_ANDN, build(f0, depth + 1), x);
+    }
+
+    if (f1 == ALL) {
+        return addNode(tt, OP_OR, x, build(f0, depth + 1));
+    }
+
+    if (f0 == ALL) {
+        int notX = addNode(~varTable(v), OP_NOT, x, 0);
+        return addNode(tt, OP_OR, notX, build(f1, depth + 1));
+    }
+
+    if (f1 == ~f0) {
+        return addNode(tt, OP_XOR, x, build(f0, depth + 1));
+    }
+
+    // f0 ^ (x & (f0 ^ f1))
+    int n0 = build(f0, depth + 1);
+    int n1 = build(f1, depth + 1);
+    int diff = findNode(f0 ^ f1);
+
+    if (diff < 0) {
+        diff = addNode(f0 ^ f1, OP_XOR, n0, n1);
+    }
+
+    int masked = addNode(tt ^ f0, OP_AND, x, diff);
+
+    return addNode(tt, OP_XOR, n0, masked);
+}
+
+static void outputTables(int box, uint64_t out[4]) {
+    for (int j = 0; j < 4; j++) {
+        out[j] = 0;
+    }
+
+    for (int m = 0; m < 64; m++) {
+        int row = ((m & 0x20) >> 4) | (m & 0x01);
+        int col = (m >> 1) & 0x0F;
+        int value = sBoxes[box][row][col];
+
+        for (int j = 0; j < 4; j++) {
+            if ((value >> (3 - j)) & 1) {
+                out[j] |= (uint64_t)1 << m;
+            }
+        }
+    }
+}
+
+static int used[MAX_NODES];
+
+static void markUsed(int n) {
+    if (used[n]) {
+        return;
+    }
+
+    used[n] = 1;
+
+    if (nodes[n].op == OP_VAR) {
+        return;
+    }
+
+    markUsed(nodes[n].a);
+
+    if (nodes[n].op != OP_NOT) {
+        markUsed(nodes[n].b);
+    }
+}
+
+// returns the number of gates actually needed by the 4 outputs
+static int buildBox(const uint64_t out[4], int roots[4]) {
+    nodeCount = 0;
+
+    for (int v = 0; v < 6; v++) {
+        addNode(varTable(v), OP_VAR, v, 0);
+    }
+
+    for (int j = 0; j < 4; j++) {
+        roots[j] = build(out[j], 0);
+    }
+
+    memset(used, 0, sizeof(used));
+
+    for (int j = 0; j < 4; j++) {
+        markUsed(roots[j]);
+    }
+
+    int gates = 0;
+
+    for (int n = 6; n < nodeCount; n++) {
+        gates += used[n];
+    }
+
+    return gates;
+}
+
+static int nextPermutation(int *a, int n) {
+    int i = n - 2;
+
+    while (i >= 0 && a[i] >= a[i + 1]) {
+        i--;
+    }
+
+    if (i < 0) {
+        return 0;
+    }
+
+    int j = n - 1;
+
+    while (a[j] <= a[i]) {
+        j--;
+    }
+
+    int t = a[i]; a[i] = a[j]; a[j] = t;
+
+    for (int l = i + 1, r = n - 1; l < r; l++, r--) {
+        t = a[l]; a[l] = a[r]; a[r] = t;
+    }
+
+    return 1;
+}
+
+static void printName(int n) {
+    if (n < 6) {
+        printf("a%d", n + 1);
+    } else {
+        printf("x%d", n);
+    }
+}
+
+int main(void) {
+    printf("// generated by helpers/bitslice-sboxes.c, do not edit\n");
+    printf("// bitsliced DES S-boxes, each bit of a slice is the same bit of a different block\n");
+    printf("// in[0..5] are the S-box inputs (in[0] is the first bit), the 4 outputs are xored\n");
+    printf("// into out1..out4 (out1 is the first output bit)\n\n");
+    printf("#ifndef DES_SBOXES_H\n#define DES_SBOXES_H\n\n");
+    printf("// expects dsv, the slice type, to be defined before this file is included\n\n");
+
+    int total = 0;
+
+    for (int box = 0; box < 8; box++) {
+        uint64_t out[4];
+        outputTables(box, out);
+
+        int best[6], bestCost = 1 << 30;
+
+        for (int i = 0; i < 6; i++) {
+            order[i] = i;
+        }
+
+        do {
+            int roots[4];
+            int cost = buildBox(out, roots);
+
+            if (cost < bestCost) {
+                bestCost = cost;
+                memcpy(best, order, sizeof(best));
+            }
+        } while (nextPermutation(order, 6));
+
+        memcpy(order, best, sizeof(order));
+
+        int roots[4];
+        buildBox(out, roots);
+        total += bestCost;
+
+        printf("// s%d, %d gates\n", box + 1, bestCost);
+        printf("static inline void bitsliceSbox%d(const dsv *in, dsv *out1, dsv *out2, dsv *out3, dsv *out4) {\n", box + 1);
+        printf("    dsv a1 = in[0], a2 = in[1], a3 = in[2], a4 = in[3], a5 = in[4], a6 = in[5];\n");
+
+        for (int n = 6; n < nodeCount; n++) {
+            if (!used[n]) {
+                continue;
+            }
+
+            printf("    dsv x%d = ", n);
+
+            switch (nodes[n].op) {
+                case OP_NOT:
+                    printf("~"); printName(nodes[n].a);
+                    break;
+                case OP_AND:
+                    printName(nodes[n].a); printf(" & "); printName(nodes[n].b);
+                    break;
+                case OP_ANDN:
+                    printName(nodes[n].a); printf(" & ~"); printName(nodes[n].b);
+                    break;
+                case OP_OR:
+                    printName(nodes[n].a); printf(" | "); printName(nodes[n].b);
+                    break;
+                case OP_XOR:
+                    printName(nodes[n].a); printf(" ^ "); printName(nodes[n].b);
+                    break;
+                default:
+                    break;
+            }
+
+            printf(";\n");
+        }
+
+        for (int j = 0; j < 4; j++) {
+            printf("    *out%d ^= ", j + 1);
+            printName(roots[j]);
+            printf(";\n");
+        }
+
+        printf("}\n\n");
+    }
+
+    printf("#endif\n");
+
+    fprintf(stderr, "%d gates total\n", total);
+
+    return 0;
+}
@@ -0,0 +1,642 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gmp.h>
+#include "../src/des.h"
+#include "../src/sha256.h"
+#include "../src/sha256Multi.h"
+#include "../src/sha256Tree.h"
+#include "../src/sha512.h"
+#include "../src/blake3.h"
+#include "../src/hmac.h"
+#include "../src/rsa.h"
+#include "../src/rsaBatch.h"
+
+/*
+    Known answer checks for the DES, hash, HMAC and RSA code in src/, run it after
+    touching any of them
+
+    cc -O2 -o helpers/known-answers helpers/known-answers.c src/des.c \
+        src/desBitslice.c src/desModes.c src/threadPool.c src/utils.c src/sha256.c \
+        src/sha256Multi.c src/sha256Tree.c src/sha512.c src/blake3.c src/hmac.c \
+        src/rsa.c src/rsaKeygen.c src/montgomery.c src/rsaBatch.c -lgmp -pthread
+    ./helpers/known-answers
+
+    None of the expected values come from this code. Where there is a published
+    example it is used (FIPS 81 and SP 800-67 for DES / 3DES, FIPS 180 for SHA-2,
+    the BLAKE3 test vectors, RFC 4231 for HMAC, RFC 5869 for HKDF), the rest was
+    computed with openssl (DES and 3DES with -provider legacy, CTS and CTR built
+    from its ECB and CBC), Python's hashlib and hmac, the BLAKE3 reference and
+    Python's pow() for RSA. Long outputs are compared through their SHA-256, which
+    is checked first. Exits with the number of failed checks.
+*/
+
+static int checks = 0;
+static int failures = 0;
+
+// the test inputs, byte i is i * 31 + seed
+static void pattern(uint8_t *buffer, size_t length, unsigned int seed) {
+    for (size_t i = 0; i < length; i++) {
+        buffer[i] = (uint8_t)(i * 31 + seed);
+    }
+}
+
+static void checkTrue(const char *name, int ok) {
+
+    checks++;
+
+    if (ok) {
+        printf("ok   %s\n", name);
+    } else {
+        printf("FAIL %s\n", name);
+        failures++;
+    }
+}
+
+static void checkHex(const char *name, const uint8_t *got, size_t length, const char *expected) {
+
+    char hex[2 * 256 + 1] = "";
+
+    for (size_t i = 0; i < length && i < 256; i++) {
+        sprintf(hex + 2 * i, "%02x", got[i]);
+    }
+
+    int ok = strcmp(hex, expected) == 0;
+
+    checkTrue(name, ok);
+
+    if (!ok) {
+        printf("     got      %s\n     expected %s\n", hex, expected);
+    }
+}
+
+// long outputs by their SHA-256
+static void checkDigest(const char *name, const uint8_t *data, size_t length,
+                        const char *expected) {
+
+    uint8_t digest[SHA256_SIZE_BYTES];
+
+    sha256(data, length, digest);
+    checkHex(name, digest, sizeof(digest), expected);
+}
+
+static void fromHex(const char *hex, uint8_t *bytes) {
+    for (size_t i = 0; hex[2 * i]; i++) {
+        sscanf(hex + 2 * i, "%2hhx", &bytes[i]);
+    }
+}
+
+static void checkSha(void) {
+
+    uint8_t digest[SHA512_SIZE_BYTES];
+    const char *longer = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+    sha256("abc", 3, digest);
+    checkHex("SHA-256 abc (FIPS 180)", digest, SHA256_SIZE_BYTES,
+             "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    sha256("", 0, digest);
+    checkHex("SHA-256 empty", digest, SHA256_SIZE_BYTES,
+             "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    sha256(longer, strlen(longer), digest);
+    checkHex("SHA-256 448 bits (FIPS 180)", digest, SHA256_SIZE_BYTES,
+             "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+    // a million a, fed in uneven pieces through the block-at-a-time path
+    uint8_t *a = (uint8_t *)malloc(1000000);
+    sha256_context ctx;
+
+    memset(a, 'a', 1000000);
+    sha256_init(&ctx);
+
+    for (size_t done = 0, step = 1; done < 1000000; done += step, step = step * 3 % 8191 + 1) {
+        sha256_hash(&ctx, a + done, done + step > 1000000 ? 1000000 - done : step);
+    }
+
+    sha256_done(&ctx, digest);
+    checkHex("SHA-256 million a (FIPS 180)", digest, SHA256_SIZE_BYTES,
+             "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    free(a);
+
+    sha512("abc", 3, digest);
+    checkHex("SHA-512 abc (FIPS 180)", digest, SHA512_SIZE_BYTES,
+             "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+             "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f");
+    sha512_256("abc", 3, digest);
+    checkHex("SHA-512/256 abc (FIPS 180)", digest, SHA512_256_SIZE_BYTES,
+             "53048e2681941ef99b2e29b76b4c7dabe4c2d0c634fc6d46e0e2f13107e7af23");
+
+    uint8_t *big = (uint8_t *)malloc(1 << 20);
+
+    pattern(big, 1 << 20, 9);
+    sha256(big, 1 << 20, digest);
+    checkHex("SHA-256 1 MB", digest, SHA256_SIZE_BYTES,
+             "fd862fc23e03997c6ad35c06b9faa2d8f364c31d64ef6758fb7f7f24d46bb52a");
+    sha512(big, 1 << 20, digest);
+    checkHex("SHA-512 1 MB", digest, SHA512_SIZE_BYTES,
+             "07d4558ef0bbdfb7687e22b01db5b593eff8022ac85134b29fc42ce9a58e56f8"
+             "2dbff4689d07f0a11d9b11989e5eaba233fbd7e5a3d394b045b1182712913582");
+    free(big);
+
+    // every short length, one at a time, two at a time and through the lanes
+    uint8_t message[300];
+    uint8_t digests[300 * SHA256_SIZE_BYTES];
+    uint8_t batched[120 * SHA256_SIZE_BYTES];
+    const void *pointers[300];
+    size_t lengths[300];
+
+    pattern(message, sizeof(message), 7);
+
+    for (size_t l = 0; l < 120; l++) {
+        sha256_short(message, l, digests + l * SHA256_SIZE_BYTES);
+        pointers[l] = message;
+        lengths[l] = l;
+    }
+
+    sha256_short_batch(pointers, lengths, batched, 120);
+    checkDigest("sha256_short lengths 0..119", digests, 120 * SHA256_SIZE_BYTES,
+                "2ba62fa655aeb96228301a6bfbfb4dd96cab80aca66627a7a478bb600f9a37a8");
+    checkDigest("sha256_short_batch lengths 0..119", batched, 120 * SHA256_SIZE_BYTES,
+                "2ba62fa655aeb96228301a6bfbfb4dd96cab80aca66627a7a478bb600f9a37a8");
+
+    pattern(message, sizeof(message), 8);
+
+    for (size_t l = 0; l < 300; l++) {
+        pointers[l] = message;
+        lengths[l] = l;
+    }
+
+    sha256Multi((const uint8_t *const *)pointers, lengths, digests, 300);
+    checkDigest("sha256Multi lengths 0..299", digests, 300 * SHA256_SIZE_BYTES,
+                "7bd0db7ca49060c6f7139217e344f064f4b763e9b6923815758be17cfe18fff5");
+}
+
+static void checkBlake3(void) {
+
+    static const size_t lengths[] = { 1023, 1024, 1025, 2049, 8193, 102400 };
+    static const char *expected[] = {
+        "10108970eeda3eb932baac1428c7a2163b0e924c9a9e25b35bba72b28f70bd11",
+        "42214739f095a406f3fc83deb889744ac00df831c10daa55189b5d121c855af7",
+        "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444",
+        "5f4d72f40d7a5f82b15ca2b2e44b1de3c2ef86c426c95c1af0b6879522563030",
+        "bab6c09cb8ce8cf459261398d2e7aef35700bf488116ceb94a36d0f5f1b7bc3b",
+        "bc3e3d41a1146b069abffad3c0d44860cf664390afce4d9661f7902e7943e085"
+    };
+
+    uint8_t digest[BLAKE3_SIZE_BYTES];
+    uint8_t *input = (uint8_t *)malloc(1 << 20);
+    char name[64];
+
+    blake3((const uint8_t *)"", 0, digest);
+    checkHex("BLAKE3 empty", digest, sizeof(digest),
+             "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262");
+
+    // the official vectors, input byte i is i % 251
+    for (size_t i = 0; i < 102400; i++) {
+        input[i] = (uint8_t)(i % 251);
+    }
+
+    for (size_t v = 0; v < sizeof(lengths) / sizeof(lengths[0]); v++) {
+        snprintf(name, sizeof(name), "BLAKE3 %zu bytes (test vectors)", lengths[v]);
+        blake3(input, lengths[v], digest);
+        checkHex(name, digest, sizeof(digest), expected[v]);
+    }
+
+    pattern(input, 1 << 20, 9);
+
+    blake3Context ctx;
+    blake3Init(&ctx);
+
+    for (size_t done = 0, step = 1; done < (1 << 20); done += step, step = step * 5 % 70001 + 1) {
+        blake3Update(&ctx, input + done, done + step > (1 << 20) ? (1 << 20) - done : step);
+    }
+
+    blake3Final(&ctx, digest);
+    checkHex("BLAKE3 1 MB streamed", digest, sizeof(digest),
+             "22f5be90f0cf89556f4520f0db915b00bdbc70e4eff9c6af210be7bdd01b0aa3");
+
+    free(input);
+}
+
+static void checkHmac(void) {
+
+    uint8_t key[131];
+    uint8_t mac[HMAC_SIZE];
+    hmacKey hk;
+
+    memset(key, 0x0b, 20);
+    hmacInit(&hk, key, 20);
+    hmacSha256(&hk, (const uint8_t *)"Hi There", 8, mac);
+    checkHex("HMAC-SHA256 (RFC 4231 case 1)", mac, sizeof(mac),
+             "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7");
+
+    const char *question = "what do ya want for nothing?";
+    hmacContext ctx;
+
+    hmacInit(&hk, (const uint8_t *)"Jefe", 4);
+    hmacStart(&ctx, &hk);
+    hmacUpdate(&ctx, (const uint8_t *)question, 10);
+    hmacUpdate(&ctx, (const uint8_t *)question + 10, strlen(question) - 10);
+    hmacFinal(&ctx, mac);
+    checkHex("HMAC-SHA256 streamed (RFC 4231 case 2)", mac, sizeof(mac),
+             "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+
+    const char *larger = "Test Using Larger Than Block-Size Key - Hash Key First";
+
+    memset(key, 0xaa, sizeof(key));
+    hmacInit(&hk, key, sizeof(key));
+    hmacSha256(&hk, (const uint8_t *)larger, strlen(larger), mac);
+    checkHex("HMAC-SHA256 long key (RFC 4231 case 6)", mac, sizeof(mac),
+             "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+
+    // RFC 5869 case 1
+    uint8_t ikm[22];
+    uint8_t salt[13];
+    uint8_t info[10];
+    uint8_t prk[HMAC_SIZE];
+    uint8_t okm[50 * 40];
+
+    memset(ikm, 0x0b, sizeof(ikm));
+
+    for (int i = 0; i < 13; i++) {
+        salt[i] = (uint8_t)i;
+    }
+
+    for (int i = 0; i < 10; i++) {
+        info[i] = (uint8_t)(0xf0 + i);
+    }
+
+    hkdfExtract(salt, sizeof(salt), ikm, sizeof(ikm), prk);
+    checkHex("HKDF extract (RFC 5869 case 1)", prk, sizeof(prk),
+             "077709362c2e32df0ddc3f0dc47bba6390b6c73bb50f9c3122ec844ad7c2b3e5");
+
+    hmacInit(&hk, prk, sizeof(prk));
+    checkTrue("HKDF expand returns", hkdfExpand(&hk, info, sizeof(info), okm, 42) == EXIT_SUCCESS);
+    checkHex("HKDF expand (RFC 5869 case 1)", okm, 42,
+             "3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf"
+             "34007208d5b887185865");
+
+    // one info per ballot through the multi-buffer path
+    char infos[50][16];
+    const uint8_t *infoList[50];
+    size_t infoLengths[50];
+
+    for (int i = 0; i < 50; i++) {
+        snprintf(infos[i], sizeof(infos[i]), "ballot %d", i);
+        infoList[i] = (const uint8_t *)infos[i];
+        infoLengths[i] = strlen(infos[i]);
+    }
+
+    checkTrue("HKDF batch returns",
+              hkdfexpandBatch(&hk, infoList, infoLengths, okm, 40, 50) == EXIT_SUCCESS);
+    checkDigest("HKDF batch of 50", okm, sizeof(okm),
+                "444519b90695b865e3d1521ffab2af146532eb41d3158b18f75b2a789fdf1541");
+}
+
+static void checkTree(void) {
+
+    uint8_t digest[SHA256_SIZE_BYTES];
+    size_t length = 3 * SHA256_TREE_LEAF_SIZE + 5;
+    uint8_t *data = (uint8_t *)malloc(length);
+
+    sha256Tree(NULL, 0, 0, digest);
+    checkHex("SHA-256 tree empty", digest, sizeof(digest),
+             "6e340b9cffb37a989ca544e6bb780a2c78901d3fb33738768511a30617afa01d");
+
+    pattern(data, length, 10);
+    sha256Tree(data, length, 0, digest);
+    checkHex("SHA-256 tree 3 MB + 5", digest, sizeof(digest),
+             "0f188d793803297b8a78658e6719d9b3f54b4459c6285d378fefb448d279d305");
+
+    pattern(data, 10000, 11);
+    sha256Tree(data, 10000, 1000, digest);
+    checkHex("SHA-256 tree 1000 byte leaves", digest, sizeof(digest),
+             "83a5d39dcd9d1dc289ea9ed9dffdcbe82270cc061b382f8128820114442193b9");
+
+    free(data);
+}
+
+static void checkDes(void) {
+
+    deskeySchedule ks;
+    uint8_t key[8];
+    uint8_t iv[8];
+    uint8_t block[8];
+    uint8_t out[32];
+
+    fromHex("133457799bbcdff1", key);
+    fromHex("0123456789abcdef", block);
+    keySchedule(&ks, key);
+    desencryptBlock(&ks, block, out);
+    checkHex("DES block", out, 8, "85e813540f0ab405");
+    desdecryptBlock(&ks, out, out);
+    checkTrue("DES block decrypt", memcmp(out, block, 8) == 0);
+
+    // FIPS 81 examples
+    const uint8_t *now = (const uint8_t *)"Now is the time for all ";
+
+    fromHex("0123456789abcdef", key);
+    fromHex("1234567890abcdef", iv);
+    keySchedule(&ks, key);
+
+    desencryptBlocks(&ks, now, out, 3);
+    checkHex("DES ECB (FIPS 81)", out, 24, "3fa40e8a984d48156a271787ab8883f9893d51ec4b563b53");
+    cbcEncrypt(&ks, iv, now, out, 24);
+    checkHex("DES CBC (FIPS 81)", out, 24, "e5c7cdde872bf27c43e934008c389c0f683788499a7c05f6");
+
+    // enough blocks for the bitsliced engine, and for the worker pool
+    size_t large = 256 * 1024 + 5;
+    uint8_t *plain = (uint8_t *)malloc(large);
+    uint8_t *cipher = (uint8_t *)malloc(large + 16);
+    uint8_t *back = (uint8_t *)malloc(large);
+
+    pattern(plain, 4096, 1);
+    desencryptBlocks(&ks, plain, cipher, 512);
+    checkDigest("DES ECB bitsliced 4096", cipher, 4096,
+                "29a5983a857a409223a2d2f07a241e35f0b20cd7916caa0a749983953951af53");
+    desdecryptBlocks(&ks, cipher, back, 512);
+    checkTrue("DES ECB bitsliced decrypt", memcmp(back, plain, 4096) == 0);
+
+    cbcEncrypt(&ks, iv, plain, cipher, 4096);
+    checkDigest("DES CBC 4096", cipher, 4096,
+                "443f6bf8127f8f862bdc37ad1c79a0cf67f6d0765398a69358ea682c286dd665");
+
+    pattern(plain, 256 * 1024, 2);
+    cbcEncrypt(&ks, iv, plain, cipher, 256 * 1024);
+    checkDigest("DES CBC 256 KB", cipher, 256 * 1024,
+                "7aff97d8bb3569c178029d4f59a43aa42c07cd136c2f76e92fd16fa81f2ed005");
+    cbcDecrypt(&ks, iv, cipher, back, 256 * 1024);
+    checkTrue("DES CBC 256 KB decrypt", memcmp(back, plain, 256 * 1024) == 0);
+    cbcdecryptParallel(&ks, iv, cipher, cipher, 256 * 1024);
+    checkTrue("DES CBC 256 KB parallel decrypt in place", memcmp(cipher, plain, 256 * 1024) == 0);
+
+    // streamed in uneven pieces, same ciphertext as in one go
+    cbcContext ctx;
+    size_t written = 0;
+
+    pattern(plain, 4096, 1);
+    cbcInit(&ctx, &ks, iv, 0);
+
+    for (size_t done = 0, step = 1; done < 4096; done += step, step = step * 3 % 97 + 1) {
+        size_t length = done + step > 4096 ? 4096 - done : step;
+        written += cbcUpdate(&ctx, plain + done, length, cipher + written);
+    }
+
+    size_t last;
+    checkTrue("DES CBC context final", cbcFinal(&ctx, cipher + written, &last) == EXIT_SUCCESS);
+    checkDigest("DES CBC context 4096", cipher, written + last,
+                "443f6bf8127f8f862bdc37ad1c79a0cf67f6d0765398a69358ea682c286dd665");
+
+    // counter just below the 64 bit wrap
+    fromHex("fffffffffffffff0", block);
+    pattern(plain, large, 3);
+    ctrEncrypt(&ks, block, 0, plain, cipher, large);
+    checkDigest("DES CTR 256 KB + 5", cipher, large,
+                "2f74178b810ed370f4c07c8b2db1b607d8a26e89f6a77108b2389ee13cff1c33");
+    ctrDecrypt(&ks, block, 13, cipher + 13, back, 1000);
+    checkTrue("DES CTR from offset 13", memcmp(back, plain + 13, 1000) == 0);
+
+    // ciphertext stealing (CS3, the two last blocks swapped)
+    static const size_t ctsLengths[] = { 8, 13, 27 };
+    static const char *ctsExpected[] = {
+        "20f03c27acbaa88f",
+        "a6abed58585b514820f03c27ac",
+        "20f03c27acbaa88ff39b2307d18ac10c04829d1f6f499b15fbb142"
+    };
+    char name[64];
+
+    for (size_t c = 0; c < 3; c++) {
+        size_t length = ctsLengths[c];
+
+        pattern(plain, length, 4);
+        snprintf(name, sizeof(name), "DES CTS %zu bytes", length);
+        ctsEncrypt(&ks, iv, plain, cipher, length);
+        checkHex(name, cipher, length, ctsExpected[c]);
+        ctsDecrypt(&ks, iv, cipher, back, length);
+        snprintf(name, sizeof(name), "DES CTS %zu bytes decrypt", length);
+        checkTrue(name, memcmp(back, plain, length) == 0);
+    }
+
+    pattern(plain, 4099, 5);
+    ctsEncrypt(&ks, iv, plain, cipher, 4099);
+    checkDigest("DES CTS 4099", cipher, 4099,
+                "4350a7ffe77c6b13029fa84aefff820149d08921ec859692160afcfeabb31be4");
+
+    written = 0;
+    ctsInit(&ctx, &ks, iv, 0);
+
+    for (size_t done = 0, step = 1; done < 4099; done += step, step = step * 7 % 101 + 1) {
+        size_t length = done + step > 4099 ? 4099 - done : step;
+        written += ctsUpdate(&ctx, plain + done, length, cipher + written);
+    }
+
+    checkTrue("DES CTS context final", ctsFinal(&ctx, cipher + written, &last) == EXIT_SUCCESS);
+    checkDigest("DES CTS context 4099", cipher, written + last,
+                "4350a7ffe77c6b13029fa84aefff820149d08921ec859692160afcfeabb31be4");
+
+    free(plain);
+    free(cipher);
+    free(back);
+}
+
+// 100 messages with their own key and IV, enough for the lanes of the engine
+static void checkStreams(void) {
+
+    static deskeySchedule schedules[100];
+    static desStream streams[100];
+    static uint8_t keys[100][8];
+    static uint8_t ivs[100][8];
+    static uint8_t plain[100][48];
+    static uint8_t cipher[100][48];
+    uint8_t all[100 * 48];
+
+    for (int stealing = 0; stealing < 2; stealing++) {
+        size_t total = 0;
+
+        for (unsigned int i = 0; i < 100; i++) {
+            size_t length = stealing ? 8 + i % 20 : 8 * (1 + i % 6);
+
+            pattern(keys[i], 8, i);
+            pattern(ivs[i], 8, 100 + i);
+            pattern(plain[i], length, 200 + i);
+            keySchedule(&schedules[i], keys[i]);
+
+            streams[i].ks = &schedules[i];
+            streams[i].iv = ivs[i];
+            streams[i].plaintext = plain[i];
+            streams[i].ciphertext = cipher[i];
+            streams[i].length = length;
+        }
+
+        if (stealing) {
+            checkTrue("DES CTS streams return", ctsencryptStreams(streams, 100) == EXIT_SUCCESS);
+        } else {
+            cbcencryptStreams(streams, 100);
+        }
+
+        for (size_t i = 0; i < 100; i++) {
+            memcpy(all + total, cipher[i], streams[i].length);
+            total += streams[i].length;
+        }
+
+        if (stealing) {
+            checkDigest("DES CTS 100 streams", all, total,
+                        "e81bb7e808aa4b54b16f836bf18f457f1cffe309bf655e55b3e6cf29f192b10f");
+        } else {
+            checkDigest("DES CBC 100 streams", all, total,
+                        "b60fae7339971bc6977ae868b39a0ff23a7eca95f38561dc0bd5a61c11313759");
+        }
+    }
+}
+
+static void checkDes3(void) {
+
+    des3keySchedule ks;
+    uint8_t key[DES3_KEY_SIZE];
+    uint8_t iv[8];
+    uint8_t plain[4096];
+    uint8_t cipher[4096];
+    uint8_t back[4096];
+
+    // SP 800-67 example
+    fromHex("0123456789abcdef23456789abcdef01456789abcdef0123", key);
+    fromHex("1234567890abcdef", iv);
+    keySchedule3(&ks, key);
+
+    des3encryptBlocks(&ks, (const uint8_t *)"The qufck brown fox jump", cipher, 3);
+    checkHex("3DES ECB (SP 800-67)", cipher, 24,
+             "a826fd8ce53b855fcce21c8112256fe668d5c05dd9b6b900");
+
+    pattern(plain, sizeof(plain), 1);
+    des3cbcEncrypt(&ks, iv, plain, cipher, sizeof(plain));
+    checkDigest("3DES CBC 4096", cipher, sizeof(plain),
+                "078d43122e80ee67137fb3a80e13afb2b2cc9a52a29abc226b0e2c1c93533a9e");
+    des3cbcDecrypt(&ks, iv, cipher, back, sizeof(plain));
+    checkTrue("3DES CBC 4096 decrypt", memcmp(back, plain, sizeof(plain)) == 0);
+
+    pattern(plain, 29, 6);
+    des3ctsEncrypt(&ks, iv, plain, cipher, 29);
+    checkHex("3DES CTS 29 bytes", cipher, 29,
+             "ebcc003123d822029090995b4e080276d2d986a1c528b23fb81428e89c");
+    des3ctsDecrypt(&ks, iv, cipher, back, 29);
+    checkTrue("3DES CTS 29 bytes decrypt", memcmp(back, plain, 29) == 0);
+}
+
+static void checkRsa(void) {
+
+    rsakeyPair keyPair;
+    mpz_t signature;
+    mpz_t expected;
+
+    rsainitkeyPair(&keyPair);
+    mpz_init(signature);
+    mpz_init(expected);
+
+    // textbook, n = 3233, d = 2753
+    uint8_t small = 65;
+
+    checkTrue("RSA toy key", rsagenkeyPair(&keyPair, "61", "53", "17") == EXIT_SUCCESS);
+    rsaSign(&keyPair, &small, 1, &signature);
+    checkTrue("RSA toy signature 65^2753 mod 3233 = 588", mpz_cmp_ui(signature, 588) == 0);
+
+    rsaclearkeyPair(&keyPair);
+    rsainitkeyPair(&keyPair);
+
+    // 2048 bit key, the signature from Python's pow(h, d, n)
+    checkTrue("RSA 2048 key",
+              rsagenkeyPair(&keyPair,
+                            "1734147572153831020408800662072936131943611048748913909792632245"
+                            "9950631740703585374565002676290306210896924724153432732048812798"
+                            "8168848309774290086247568107707475625307096706093473602440424766"
+                            "9504981313463655967447576246709460550213432535392854191919312737"
+                            "75839241885699213395074954938431389294282231282487759",
+                            "1413381214223412633601624073937079013180930868531980145725132771"
+                            "1606706451919430446616473173144605327964155136316120813959472036"
+                            "7154175296370838881850561240463825773854114456069191815508373281"
+                            "5899778342955785045588038540704249172567810593982472886606443697"
+                            "70227909590651620207863441884352979809206056304845791",
+                            "65537") == EXIT_SUCCESS);
+
+    uint8_t hash[SHA256_SIZE_BYTES];
+
+    sha256("abc", 3, hash);
+    mpz_set_str(expected,
+                "afd8a571d48b871ed1b838d9d90168bc58a71a25b819c3d9582fbbd42cc324e5"
+                "a78fa4c63937da21f2d8f05ef4d9a3ac42c9cd3809ad836a7bc894d260494c59"
+                "3fd2c4244dd39f0407bab648d87e82fa78867a4ba480d38be66b5cfab5e225e3"
+                "e2920445a34466e9b06e2b2a7a6d11289df9ed55ef190ae6304cfe310713ac7f"
+                "f01bcddc566b19becebbfba952f8b1104925d91f2890f1b3e14a31d93e3fb928"
+                "dfac1df15344448350550b572e76576bbbbbc1840cc4d963ef98e2fdea167262"
+                "0119253a79775ce0ba3b18a350b6e193c1e5d9848a396f8399a84f18119f22e4"
+                "776ae2e1c8355211295ccff534a570768edffc6a5ab67132193ce40c8b80fe29", 16);
+
+    rsaSign(&keyPair, hash, sizeof(hash), &signature);
+    checkTrue("RSA 2048 sign SHA-256(abc)", mpz_cmp(signature, expected) == 0);
+    checkTrue("RSA 2048 verify", rsaVerify(&keyPair, hash, sizeof(hash), signature));
+
+    mpz_sub(expected, keyPair.n, signature);
+    checkTrue("RSA 2048 verify n - s", rsaVerify(&keyPair, hash, sizeof(hash), expected));
+
+    mpz_add_ui(expected, signature, 1);
+    checkTrue("RSA 2048 reject s + 1", !rsaVerify(&keyPair, hash, sizeof(hash), expected));
+
+    // a batch of 20 with one n - s and one bad signature
+    uint8_t hashes[20][SHA256_SIZE_BYTES];
+    const unsigned char *hashList[20];
+    size_t hashLengths[20];
+    mpz_t signatures[20];
+    mpz_srcptr signatureList[20];
+    int valid[20];
+    int agree = 1;
+
+    for (int i = 0; i < 20; i++) {
+        char ballot[16];
+
+        snprintf(ballot, sizeof(ballot), "ballot %d", i);
+        sha256(ballot, strlen(ballot), hashes[i]);
+
+        mpz_init(signatures[i]);
+        rsaSign(&keyPair, hashes[i], SHA256_SIZE_BYTES, &signatures[i]);
+
+        hashList[i] = hashes[i];
+        hashLengths[i] = SHA256_SIZE_BYTES;
+        signatureList[i] = signatures[i];
+    }
+
+    checkTrue("RSA 2048 batch of 20",
+              rsaverifyBatch(&keyPair, hashList, hashLengths, signatureList, 20, valid));
+
+    mpz_sub(signatures[3], keyPair.n, signatures[3]);
+    mpz_add_ui(signatures[7], signatures[7], 1);
+
+    checkTrue("RSA 2048 batch with a bad signature fails",
+              !rsaverifyBatch(&keyPair, hashList, hashLengths, signatureList, 20, valid));
+
+    for (int i = 0; i < 20; i++) {
+        agree &= valid[i] == (i != 7);
+        agree &= valid[i] == rsaVerify(&keyPair, hashes[i], SHA256_SIZE_BYTES, signatures[i]);
+        mpz_clear(signatures[i]);
+    }
+
+    checkTrue("RSA 2048 batch agrees with rsaVerify", agree);
+
+    mpz_clear(signature);
+    mpz_clear(expected);
+    rsaclearkeyPair(&keyPair);
+}
+
+int main(void) {
+
+    // the hashes first, the long outputs below are compared through SHA-256
+    checkSha();
+    checkBlake3();
+    checkHmac();
+    checkTree();
+    checkDes();
+    checkStreams();
+    checkDes3();
+    checkRsa();
+
+    printf("%d checks, %d failed\n", checks, failures);
+
+    return failures;
+}
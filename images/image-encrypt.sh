@@ -5,8 +5,11 @@ mkdir -p bin
 gcc -Wall -Wextra -o bin/encryptImage \
     src/encryptImage.c \
     src/des.c \
+    src/desBitslice.c \
     src/desModes.c \
-    src/utils.c
+    src/threadPool.c \
+    src/utils.c \
+    -pthread
 
 if [ $? -eq 0 ]; then
     echo "Build successful! You can run the BMP encryption demo with: bin/encryptImage <bmp_file>"
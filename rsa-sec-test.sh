@@ -6,6 +6,7 @@ gcc -Wall -Wextra -o bin/rsashortAttack \
     src/rsashortAttack.c \
     src/rsa.c \
     src/rsaKeygen.c \
+    src/montgomery.c \
     src/utils.c \
     -lgmp -lm
 
@@ -0,0 +1,389 @@
+#include <string.h>
+#include "blake3.h"
+#include "threadPool.h"
+
+// https://github.com/BLAKE3-team/BLAKE3-specs/blob/master/blake3.pdf
+
+#define CHUNK_START 1
+#define CHUNK_END 2
+#define PARENT 4
+#define ROOT 8
+
+// chunks per threadpoolFor, their chaining values are kept on the stack
+#define BATCH_CHUNKS 1024
+
+// below this many chunks a vector costs more than hashing them one by one
+#define MIN_LANES 4
+
+// one 32 bit word of every lane
+typedef uint32_t b3v __attribute__((vector_size(4 * BLAKE3_LANES)));
+
+// the SHA-256 initial hash
+static const uint32_t IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+// message word order of every round, the permutation applied 0 to 6 times
+static const uint8_t schedule[7][16] = {
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+    { 2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8 },
+    { 3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1 },
+    { 10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6 },
+    { 12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4 },
+    { 9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7 },
+    { 11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13 }
+};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+// the mixing function, the same for plain words and for vectors of lanes
+#define G(v, a, b, c, d, x, y)                 \
+    do {                                       \
+        v[a] += v[b] + (x);                    \
+        v[d] = ROTR(v[d] ^ v[a], 16);          \
+        v[c] += v[d];                          \
+        v[b] = ROTR(v[b] ^ v[c], 12);          \
+        v[a] += v[b] + (y);                    \
+        v[d] = ROTR(v[d] ^ v[a], 8);           \
+        v[c] += v[d];                          \
+        v[b] = ROTR(v[b] ^ v[c], 7);           \
+    } while (0)
+
+// columns then diagonals
+#define ROUND(v, m, s)                         \
+    do {                                       \
+        G(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);   \
+        G(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);   \
+        G(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);  \
+        G(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);  \
+        G(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);  \
+        G(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);\
+        G(v, 2, 7, 8, 13, m[s[12]], m[s[13]]); \
+        G(v, 3, 4, 9, 14, m[s[14]], m[s[15]]); \
+    } while (0)
+
+static inline uint32_t loadWord(const uint8_t *bytes) {
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+           ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+// new chaining value in out, which may be cv or part of m
+static void compressWords(const uint32_t cv[8], const uint32_t m[16], uint32_t blockLength,
+                          uint64_t counter, uint32_t flags, uint32_t out[8]) {
+
+    uint32_t v[16];
+    uint32_t w[16];
+
+    memcpy(w, m, sizeof(w));
+    memcpy(v, cv, 8 * sizeof(uint32_t));
+    memcpy(v + 8, IV, 4 * sizeof(uint32_t));
+
+    v[12] = (uint32_t)counter;
+    v[13] = (uint32_t)(counter >> 32);
+    v[14] = blockLength;
+    v[15] = flags;
+
+    for (int r = 0; r < 7; r++) {
+        ROUND(v, w, schedule[r]);
+    }
+
+    for (int i = 0; i < 8; i++) {
+        out[i] = v[i] ^ v[i + 8];
+    }
+}
+
+static void compressBlock(const uint32_t cv[8], const uint8_t *block, uint32_t blockLength,
+                          uint64_t counter, uint32_t flags, uint32_t out[8]) {
+
+    uint32_t m[16];
+
+    for (int j = 0; j < 16; j++) {
+        m[j] = loadWord(block + 4 * j);
+    }
+
+    compressWords(cv, m, blockLength, counter, flags, out);
+}
+
+static void parentNode(const uint32_t left[8], const uint32_t right[8], uint32_t flags,
+                       uint32_t out[8]) {
+
+    uint32_t m[16];
+
+    memcpy(m, left, 8 * sizeof(uint32_t));
+    memcpy(m + 8, right, 8 * sizeof(uint32_t));
+
+    compressWords(IV, m, BLAKE3_BLOCK_SIZE, 0, PARENT | flags, out);
+}
+
+// one whole chunk that is not the root
+static void hashChunk(const uint8_t *chunk, uint64_t counter, uint32_t out[8]) {
+
+    memcpy(out, IV, sizeof(IV));
+
+    for (int b = 0; b < 16; b++) {
+        uint32_t flags = (b == 0 ? CHUNK_START : 0) | (b == 15 ? CHUNK_END : 0);
+
+        compressBlock(out, chunk + b * BLAKE3_BLOCK_SIZE, BLAKE3_BLOCK_SIZE, counter, flags,
+                      out);
+    }
+}
+
+// shuffle masks of the transpose, the new rows i and i + s of every step below
+static const b3v lowHalves[4] = {
+    { 0, 1, 2, 3, 4, 5, 6, 7, 16, 17, 18, 19, 20, 21, 22, 23 },
+    { 0, 1, 2, 3, 16, 17, 18, 19, 8, 9, 10, 11, 24, 25, 26, 27 },
+    { 0, 1, 16, 17, 4, 5, 20, 21, 8, 9, 24, 25, 12, 13, 28, 29 },
+    { 0, 16, 2, 18, 4, 20, 6, 22, 8, 24, 10, 26, 12, 28, 14, 30 }
+};
+
+static const b3v highHalves[4] = {
+    { 8, 9, 10, 11, 12, 13, 14, 15, 24, 25, 26, 27, 28, 29, 30, 31 },
+    { 4, 5, 6, 7, 20, 21, 22, 23, 12, 13, 14, 15, 28, 29, 30, 31 },
+    { 2, 3, 18, 19, 6, 7, 22, 23, 10, 11, 26, 27, 14, 15, 30, 31 },
+    { 1, 17, 3, 19, 5, 21, 7, 23, 9, 25, 11, 27, 13, 29, 15, 31 }
+};
+
+// rows[l] holds the block words of lane l, afterwards rows[j] holds word j of every
+// lane: step k swaps the off diagonal s x s blocks, s = 8 >> k (16 lanes only)
+static inline __attribute__((always_inline)) void transpose(b3v *rows) {
+
+    for (int k = 0; k < 4; k++) {
+        int s = 8 >> k;
+
+        for (int i = 0; i < 16; i++) {
+            if ((i & s) == 0) {
+                b3v a = rows[i];
+                b3v b = rows[i + s];
+
+                rows[i] = __builtin_shuffle(a, b, lowHalves[k]);
+                rows[i + s] = __builtin_shuffle(a, b, highHalves[k]);
+            }
+        }
+    }
+}
+
+// BLAKE3_LANES whole chunks side by side, chunks[l] gets counter + l
+__attribute__((target_clones("avx512f", "avx2", "default")))
+static void hashLanes(const uint8_t *const *chunks, uint64_t counter, uint32_t cvs[][8]) {
+
+    b3v h[8];
+    b3v counterLow, counterHigh;
+
+    for (int i = 0; i < 8; i++) {
+        h[i] = (b3v){ 0 } + IV[i];
+    }
+
+    for (int l = 0; l < BLAKE3_LANES; l++) {
+        counterLow[l] = (uint32_t)(counter + l);
+        counterHigh[l] = (uint32_t)((counter + l) >> 32);
+    }
+
+    for (int b = 0; b < 16; b++) {
+        b3v m[16];
+        b3v v[16];
+
+        // a block is as wide as a vector, load it whole and transpose
+        for (int l = 0; l < BLAKE3_LANES; l++) {
+            for (int j = 0; j < 16; j++) {
+                m[l][j] = loadWord(chunks[l] + b * BLAKE3_BLOCK_SIZE + 4 * j);
+            }
+        }
+
+        transpose(m);
+
+        for (int i = 0; i < 8; i++) {
+            v[i] = h[i];
+        }
+
+        for (int i = 0; i < 4; i++) {
+            v[8 + i] = (b3v){ 0 } + IV[i];
+        }
+
+        v[12] = counterLow;
+        v[13] = counterHigh;
+        v[14] = (b3v){ 0 } + BLAKE3_BLOCK_SIZE;
+        v[15] = (b3v){ 0 } + (uint32_t)((b == 0 ? CHUNK_START : 0) | (b == 15 ? CHUNK_END : 0));
+
+        for (int r = 0; r < 7; r++) {
+            ROUND(v, m, schedule[r]);
+        }
+
+        for (int i = 0; i < 8; i++) {
+            h[i] = v[i] ^ v[i + 8];
+        }
+    }
+
+    for (int l = 0; l < BLAKE3_LANES; l++) {
+        for (int i = 0; i < 8; i++) {
+            cvs[l][i] = h[i][l];
+        }
+    }
+}
+
+typedef struct {
+    const uint8_t *data;
+    uint64_t counter;
+    size_t count;
+    uint32_t (*cvs)[8];
+} chunkJob;
+
+// BLAKE3_LANES chunks of the batch (fewer at the end)
+static void chunkTask(void *arg, size_t index) {
+
+    chunkJob *job = (chunkJob *)arg;
+    size_t first = index * BLAKE3_LANES;
+    size_t lanes = job->count - first < BLAKE3_LANES ? job->count - first : BLAKE3_LANES;
+
+    if (lanes < MIN_LANES) {
+        for (size_t l = 0; l < lanes; l++) {
+            hashChunk(job->data + (first + l) * BLAKE3_CHUNK_SIZE, job->counter + first + l,
+                      job->cvs[first + l]);
+        }
+
+        return;
+    }
+
+    // unused lanes hash the first chunk again, their result is dropped
+    const uint8_t *chunks[BLAKE3_LANES];
+    uint32_t cvs[BLAKE3_LANES][8];
+
+    for (size_t l = 0; l < BLAKE3_LANES; l++) {
+        chunks[l] = job->data + (first + (l < lanes ? l : 0)) * BLAKE3_CHUNK_SIZE;
+    }
+
+    hashLanes(chunks, job->counter + first, cvs);
+
+    memcpy(job->cvs[first], cvs, lanes * sizeof(cvs[0]));
+}
+
+// add the chaining value of a finished chunk, totalChunks counts it too
+static void pushChunk(blake3Context *ctx, const uint32_t cv[8], uint64_t totalChunks) {
+
+    uint32_t node[8];
+
+    memcpy(node, cv, sizeof(node));
+
+    // every trailing zero bit of the count closes a complete subtree
+    while ((totalChunks & 1) == 0) {
+        ctx->stackSize--;
+        parentNode(ctx->stack[ctx->stackSize], node, 0, node);
+        totalChunks >>= 1;
+    }
+
+    memcpy(ctx->stack[ctx->stackSize], node, sizeof(node));
+    ctx->stackSize++;
+}
+
+// count whole chunks straight from data, none of them the last one of the input
+static void hashChunks(blake3Context *ctx, const uint8_t *data, size_t count) {
+
+    uint32_t cvs[BATCH_CHUNKS][8];
+
+    while (count > 0) {
+        size_t batch = count < BATCH_CHUNKS ? count : BATCH_CHUNKS;
+        chunkJob job = { data, ctx->chunkCounter, batch, cvs };
+
+        threadpoolFor((batch + BLAKE3_LANES - 1) / BLAKE3_LANES, chunkTask, &job);
+
+        for (size_t i = 0; i < batch; i++) {
+            ctx->chunkCounter++;
+            pushChunk(ctx, cvs[i], ctx->chunkCounter);
+        }
+
+        data += batch * BLAKE3_CHUNK_SIZE;
+        count -= batch;
+    }
+}
+
+static void startChunk(blake3Context *ctx, uint64_t counter) {
+    memcpy(ctx->cv, IV, sizeof(IV));
+    ctx->chunkCounter = counter;
+    ctx->blockLength = 0;
+    ctx->blocksCompressed = 0;
+}
+
+void blake3Init(blake3Context *ctx) {
+    startChunk(ctx, 0);
+    ctx->stackSize = 0;
+}
+
+void blake3Update(blake3Context *ctx, const uint8_t *data, size_t length) {
+
+    while (length > 0) {
+        // a full chunk followed by more input is not the root, close it
+        if (ctx->blocksCompressed == 15 && ctx->blockLength == BLAKE3_BLOCK_SIZE) {
+            uint32_t cv[8];
+
+            compressBlock(ctx->cv, ctx->block, BLAKE3_BLOCK_SIZE, ctx->chunkCounter, CHUNK_END,
+                          cv);
+            pushChunk(ctx, cv, ctx->chunkCounter + 1);
+            startChunk(ctx, ctx->chunkCounter + 1);
+        }
+
+        // at a chunk boundary whole chunks skip the buffer, all but the last one
+        if (ctx->blocksCompressed == 0 && ctx->blockLength == 0 && length > BLAKE3_CHUNK_SIZE) {
+            size_t chunks = (length - 1) / BLAKE3_CHUNK_SIZE;
+
+            hashChunks(ctx, data, chunks);
+
+            data += chunks * BLAKE3_CHUNK_SIZE;
+            length -= chunks * BLAKE3_CHUNK_SIZE;
+        }
+
+        // same for a full block, it is only known not to be the last one now
+        if (ctx->blockLength == BLAKE3_BLOCK_SIZE) {
+            compressBlock(ctx->cv, ctx->block, BLAKE3_BLOCK_SIZE, ctx->chunkCounter,
+                          ctx->blocksCompressed == 0 ? CHUNK_START : 0, ctx->cv);
+            ctx->blocksCompressed++;
+            ctx->blockLength = 0;
+        }
+
+        size_t n = BLAKE3_BLOCK_SIZE - ctx->blockLength;
+
+        if (n > length) {
+            n = length;
+        }
+
+        memcpy(ctx->block + ctx->blockLength, data, n);
+        ctx->blockLength += (uint32_t)n;
+        data += n;
+        length -= n;
+    }
+}
+
+void blake3Final(const blake3Context *ctx, uint8_t *digest) {
+
+    uint8_t block[BLAKE3_BLOCK_SIZE] = { 0 };
+    uint32_t flags = CHUNK_END | (ctx->blocksCompressed == 0 ? CHUNK_START : 0);
+    uint32_t out[8];
+
+    memcpy(block, ctx->block, ctx->blockLength);
+
+    // a single chunk is the root itself, else the root is the top parent node
+    if (ctx->stackSize == 0) {
+        compressBlock(ctx->cv, block, ctx->blockLength, ctx->chunkCounter, flags | ROOT, out);
+    } else {
+        compressBlock(ctx->cv, block, ctx->blockLength, ctx->chunkCounter, flags, out);
+
+        for (uint32_t i = ctx->stackSize; i-- > 0;) {
+            parentNode(ctx->stack[i], out, i == 0 ? ROOT : 0, out);
+        }
+    }
+
+    for (int i = 0; i < 8; i++) {
+        digest[4 * i] = (uint8_t)out[i];
+        digest[4 * i + 1] = (uint8_t)(out[i] >> 8);
+        digest[4 * i + 2] = (uint8_t)(out[i] >> 16);
+        digest[4 * i + 3] = (uint8_t)(out[i] >> 24);
+    }
+}
+
+void blake3(const uint8_t *data, size_t length, uint8_t *digest) {
+
+    blake3Context ctx;
+
+    blake3Init(&ctx);
+    blake3Update(&ctx, data, length);
+    blake3Final(&ctx, digest);
+}
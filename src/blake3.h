@@ -0,0 +1,47 @@
+#ifndef BLAKE3_H
+#define BLAKE3_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+    BLAKE3 (https://github.com/BLAKE3-team/BLAKE3-specs), for internal integrity
+    checks that do not need a SHA-2 (ballot logs, dedup fingerprints, ...)
+
+    The input is cut in 1 KiB chunks that are hashed independently and merged in a
+    binary tree, so long inputs are hashed BLAKE3_LANES chunks at a time with the
+    same vector code as sha256Multi.c, and batches of those over the worker pool.
+    Short inputs (one chunk) take the plain scalar compression.
+*/
+
+#define BLAKE3_SIZE_BYTES 32
+#define BLAKE3_BLOCK_SIZE 64
+#define BLAKE3_CHUNK_SIZE 1024
+
+// chunks hashed side by side in one vector
+#define BLAKE3_LANES 16
+
+// enough for 2^54 chunks, more than a 64 bit length can hold
+#define BLAKE3_MAX_DEPTH 54
+
+typedef struct {
+    // chaining value of the chunk being hashed
+    uint32_t cv[8];
+    uint64_t chunkCounter;
+    uint8_t block[BLAKE3_BLOCK_SIZE];
+    // a full block is kept until more input shows it is not the last one
+    uint32_t blockLength;
+    uint32_t blocksCompressed;
+    // chaining values of the finished subtrees, largest first
+    uint32_t stack[BLAKE3_MAX_DEPTH][8];
+    uint32_t stackSize;
+} blake3Context;
+
+void blake3Init(blake3Context *ctx);
+void blake3Update(blake3Context *ctx, const uint8_t *data, size_t length);
+// writes BLAKE3_SIZE_BYTES, ctx can be updated further afterwards
+void blake3Final(const blake3Context *ctx, uint8_t *digest);
+
+void blake3(const uint8_t *data, size_t length, uint8_t *digest);
+
+#endif
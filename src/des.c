@@ -1,5 +1,7 @@
 #include <stdio.h>
 #include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include "constants.h"
 #include "utils.h"
 #include "des.h"
@@ -9,12 +11,48 @@ DES implementation from scratch based on FIPS 46-3 specification
 https://csrc.nist.gov/files/pubs/fips/46-3/final/docs/fips46-3.pdf
 */
 
+// PC1 and PC2 one input byte at a time: lut[b][v] is the permutation of an input
+// that is all zeros except byte b (MSB first) = v, the full permutation is the OR
+// of one lookup per byte
+static uint64_t pc1Lookup[8][256];
+static uint64_t pc2Lookup[7][256];
+static pthread_once_t keyTablesOnce = PTHREAD_ONCE_INIT;
+
+static void buildkeyTables(void) {
+
+    for (int b = 0; b < 8; b++) {
+        for (int v = 0; v < 256; v++) {
+            pc1Lookup[b][v] = permute((uint64_t)v << (56 - 8 * b), pc1Table, 56, 64);
+        }
+    }
+
+    for (int b = 0; b < 7; b++) {
+        for (int v = 0; v < 256; v++) {
+            pc2Lookup[b][v] = permute((uint64_t)v << (48 - 8 * b), pc2Table, 48, 56);
+        }
+    }
+}
+
+static uint64_t lookupPermute(const uint64_t (*lookup)[256], uint64_t input, int bytes) {
+
+    uint64_t output = 0;
+
+    for (int b = 0; b < bytes; b++) {
+        output |= lookup[b][(input >> (8 * (bytes - 1 - b))) & 0xFF];
+    }
+
+    return output;
+}
+
 void keySchedule(deskeySchedule *ks, const uint8_t *key) {
 
+    pthread_once(&keyTablesOnce, buildkeyTables);
+
     uint64_t keyBits = bytestoUint64(key);
+    ks->key = keyBits;
 
     // pc1
-    uint64_t permuted_key = permute(keyBits, pc1Table, 56, 64);
+    uint64_t permuted_key = lookupPermute(pc1Lookup, keyBits, 8);
 
     // split to c (left) and d (right)
     uint32_t C = (uint32_t)(permuted_key >> 28);
@@ -29,47 +67,183 @@ void keySchedule(deskeySchedule *ks, const uint8_t *key) {
         uint64_t combined = ((uint64_t)C << 28) | D;
 
         // pc2
-        ks->roundKeys[i] = permute(combined, pc2Table, 48, 56);
+        ks->roundKeys[i] = lookupPermute(pc2Lookup, combined, 7);
+
+        // split the 48 bits into the eight 6 bit S-box chunks, odd and even S-boxes go
+        // to separate words so each chunk sits in its own byte (see feistelFunction)
+        uint32_t odd = 0, even = 0;
+
+        for (int j = 0; j < 8; j += 2) {
+            odd = (odd << 8) | ((ks->roundKeys[i] >> (42 - j * 6)) & 0x3F);
+            even = (even << 8) | ((ks->roundKeys[i] >> (36 - j * 6)) & 0x3F);
+        }
+
+        ks->splitKeys[i][0] = odd;
+        ks->splitKeys[i][1] = even;
     }
 }
 
-static uint32_t feistelFunction(uint32_t R, uint64_t roundKey) {
+/*
+    Key schedule cache
+
+    Direct mapped, one slot per hash of the key. Every slot is a seqlock: the
+    writer makes the sequence odd, stores the schedule and makes it even again,
+    a reader copies the schedule and only trusts it if the sequence was the same
+    even number before and after. Readers never wait, a busy or torn slot is just
+    a miss, and a writer that finds the slot busy does not cache at all.
+*/
 
-    // from 32 bits to 48 bits
-    uint64_t expnadedRound = permute(R, expansionPerm, 48, 32);
+#define KEY_CACHE_SLOTS 64
+#define KEY_CACHE_WORDS ((sizeof(deskeySchedule) + 7) / 8)
 
-    // xor
-    expnadedRound ^= roundKey;
+typedef struct {
+    atomic_uint sequence;
+    // 0 for an empty slot, 1 once it holds a schedule
+    _Atomic uint64_t used;
+    // the schedule as 64 bit words so it can be copied with atomic loads/stores
+    _Atomic uint64_t words[KEY_CACHE_WORDS];
+} keycacheSlot;
+
+static keycacheSlot keyCache[KEY_CACHE_SLOTS];
+
+static keycacheSlot *keycacheSlotFor(uint64_t keyBits) {
+    // fibonacci hashing, the top 6 bits pick one of the 64 slots
+    return &keyCache[(keyBits * 0x9E3779B97F4A7C15ULL) >> 58];
+}
+
+void keyscheduleCached(deskeySchedule *ks, const uint8_t *key) {
+
+    uint64_t keyBits = bytestoUint64(key);
+    keycacheSlot *slot = keycacheSlotFor(keyBits);
+    uint64_t words[KEY_CACHE_WORDS];
 
-    // S-boxes
+    unsigned before = atomic_load_explicit(&slot->sequence, memory_order_acquire);
 
-    uint32_t output = 0;
+    if (!(before & 1)) {
+        uint64_t used = atomic_load_explicit(&slot->used, memory_order_relaxed);
 
-    for (int i = 0; i < 8; i++) {
-        // Extract 6 bit chunks
-        int bit_pos = 42 - (i * 6);
-        uint8_t s_input = (expnadedRound >> bit_pos) & 0x3F;
+        for (size_t i = 0; i < KEY_CACHE_WORDS; i++) {
+            words[i] = atomic_load_explicit(&slot->words[i], memory_order_relaxed);
+        }
 
-        // Calculate row and column for S-box lookup
-        uint8_t row = ((s_input & 0x20) >> 4) | (s_input & 0x01);
-        uint8_t col = (s_input >> 1) & 0x0F;
+        atomic_thread_fence(memory_order_acquire);
 
-        // S-box substitution
-        uint8_t s_output = sBoxes[i][row][col];
+        unsigned after = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
 
-        // Add to output (4 bits at a time)
-        output = (output << 4) | s_output;
+        memcpy(ks, words, sizeof(deskeySchedule));
+
+        if (before == after && used && ks->key == keyBits) {
+            return;
+        }
+    }
+
+    keySchedule(ks, key);
+
+    // claim the slot, if someone else is writing it just leave it to them
+    if (before & 1 ||
+        !atomic_compare_exchange_strong_explicit(&slot->sequence, &before, before + 1,
+                                                 memory_order_acquire, memory_order_relaxed)) {
+        return;
     }
 
-    // now do the sbox permutation
-    return permute(output, sboxPerm, 32, 32);
+    atomic_thread_fence(memory_order_release);
+
+    memset(words, 0, sizeof(words));
+    memcpy(words, ks, sizeof(deskeySchedule));
+
+    atomic_store_explicit(&slot->used, 1, memory_order_relaxed);
+
+    for (size_t i = 0; i < KEY_CACHE_WORDS; i++) {
+        atomic_store_explicit(&slot->words[i], words[i], memory_order_relaxed);
+    }
+
+    atomic_store_explicit(&slot->sequence, before + 2, memory_order_release);
 }
 
-void desencryptBlock(const deskeySchedule *ks, const uint8_t *plaintext, uint8_t *ciphertext) {
+void keyschedulecacheClear(void) {
+
+    for (size_t s = 0; s < KEY_CACHE_SLOTS; s++) {
+        keycacheSlot *slot = &keyCache[s];
+        unsigned sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+
+        // wait for a writer that is in the middle of this slot
+        while (sequence & 1 ||
+               !atomic_compare_exchange_weak_explicit(&slot->sequence, &sequence, sequence + 1,
+                                                      memory_order_acquire, memory_order_relaxed)) {
+            sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+        }
+
+        atomic_thread_fence(memory_order_release);
 
-    uint64_t block = bytestoUint64(plaintext);
+        atomic_store_explicit(&slot->used, 0, memory_order_relaxed);
 
-    block = permute(block, initialPerm, 64, 64);
+        for (size_t i = 0; i < KEY_CACHE_WORDS; i++) {
+            atomic_store_explicit(&slot->words[i], 0, memory_order_relaxed);
+        }
+
+        // a new even sequence, readers in the middle of a copy see it changed
+        atomic_store_explicit(&slot->sequence, sequence + 2, memory_order_release);
+    }
+}
+
+static uint32_t feistelFunction(uint32_t R, const uint32_t *splitKey) {
+
+    // the expansion only duplicates bits, S-box i reads R bits 4i .. 4i+5 (bit 0 = bit 32)
+    // rotating R right by 3 lines up the chunks of S-boxes 1,3,5,7 with the low 6 bits
+    // of each byte, rotating left by 1 does the same for S-boxes 2,4,6,8
+    // so there is no need for permute(R, expansionPerm, 48, 32)
+    uint32_t odd = ((R >> 3) | (R << 29)) ^ splitKey[0];
+    uint32_t even = ((R << 1) | (R >> 31)) ^ splitKey[1];
+
+    // each spBoxes entry is the S-box output already moved by sboxPerm, so the
+    // P-box is just the OR (XOR) of the 8 lookups
+    return spBoxes[0][(odd >> 24) & 0x3F] ^ spBoxes[2][(odd >> 16) & 0x3F] ^
+           spBoxes[4][(odd >> 8) & 0x3F] ^ spBoxes[6][odd & 0x3F] ^
+           spBoxes[1][(even >> 24) & 0x3F] ^ spBoxes[3][(even >> 16) & 0x3F] ^
+           spBoxes[5][(even >> 8) & 0x3F] ^ spBoxes[7][even & 0x3F];
+}
+
+// one delta swap: exchange the bits of a selected by (mask << shift) with the bits
+// of b selected by mask
+#define DELTA_SWAP(a, b, shift, mask) do { \
+    uint32_t t_ = (((a) >> (shift)) ^ (b)) & (mask); \
+    (b) ^= t_; \
+    (a) ^= t_ << (shift); \
+} while (0)
+
+uint64_t desinitialPermute(uint64_t block) {
+
+    // same result as permute(block, initialPerm, 64, 64) but done with 5 delta swaps
+    // between the two halves instead of 64 single bit moves
+    // (the IP table is just a transpose of the 8x8 bit matrix of the block)
+    uint32_t L = (uint32_t)(block >> 32);
+    uint32_t R = (uint32_t)(block & 0xFFFFFFFF);
+
+    DELTA_SWAP(L, R, 4, 0x0F0F0F0F);
+    DELTA_SWAP(L, R, 16, 0x0000FFFF);
+    DELTA_SWAP(R, L, 2, 0x33333333);
+    DELTA_SWAP(R, L, 8, 0x00FF00FF);
+    DELTA_SWAP(L, R, 1, 0x55555555);
+
+    return ((uint64_t)L << 32) | R;
+}
+
+uint64_t desfinalPermute(uint64_t block) {
+
+    // finalPerm is IP^-1, so just undo the swaps in reverse order
+    uint32_t L = (uint32_t)(block >> 32);
+    uint32_t R = (uint32_t)(block & 0xFFFFFFFF);
+
+    DELTA_SWAP(L, R, 1, 0x55555555);
+    DELTA_SWAP(R, L, 8, 0x00FF00FF);
+    DELTA_SWAP(R, L, 2, 0x33333333);
+    DELTA_SWAP(L, R, 16, 0x0000FFFF);
+    DELTA_SWAP(L, R, 4, 0x0F0F0F0F);
+
+    return ((uint64_t)L << 32) | R;
+}
+
+uint64_t desencryptPermuted(const deskeySchedule *ks, uint64_t block) {
 
     // split to LPT and RPT
     uint32_t L = (uint32_t)(block >> 32);
@@ -80,24 +254,15 @@ void desencryptBlock(const deskeySchedule *ks, const uint8_t *plaintext, uint8_t
     for (int i = 0; i < 16; i++) {
         uint32_t temp = L;
         L = R;
-        R = temp ^ feistelFunction(R, ks->roundKeys[i]);
+        R = temp ^ feistelFunction(R, ks->splitKeys[i]);
     }
 
     // swap L and R
     // after 16 rounds, L is the right half and R is the left half
-    block = ((uint64_t)R << 32) | L;
-
-
-    block = permute(block, finalPerm, 64, 64);
-
-    uint64toBytes(block, ciphertext);
+    return ((uint64_t)R << 32) | L;
 }
 
-void desdecryptBlock(const deskeySchedule *ks, const uint8_t *ciphertext, uint8_t *plaintext) {
-
-    uint64_t block = bytestoUint64(ciphertext);
-
-    block = permute(block, initialPerm, 64, 64);
+uint64_t desdecryptPermuted(const deskeySchedule *ks, uint64_t block) {
 
     uint32_t L = (uint32_t)(block >> 32);
     uint32_t R = (uint32_t)(block & 0xFFFFFFFF);
@@ -107,13 +272,75 @@ void desdecryptBlock(const deskeySchedule *ks, const uint8_t *ciphertext, uint8_
     for (int i = 15; i >= 0; i--) {
         uint32_t temp = L;
         L = R;
-        R = temp ^ feistelFunction(R, ks->roundKeys[i]);
+        R = temp ^ feistelFunction(R, ks->splitKeys[i]);
     }
 
     // now just swap
-    block = ((uint64_t)R << 32) | L;
+    return ((uint64_t)R << 32) | L;
+}
+
+void desencryptBlock(const deskeySchedule *ks, const uint8_t *plaintext, uint8_t *ciphertext) {
+
+    uint64_t block = desinitialPermute(bytestoUint64(plaintext));
+
+    block = desencryptPermuted(ks, block);
+
+    uint64toBytes(desfinalPermute(block), ciphertext);
+}
+
+void desdecryptBlock(const deskeySchedule *ks, const uint8_t *ciphertext, uint8_t *plaintext) {
+
+    uint64_t block = desinitialPermute(bytestoUint64(ciphertext));
 
-    block = permute(block, finalPerm, 64, 64);
+    block = desdecryptPermuted(ks, block);
 
-    uint64toBytes(block, plaintext);
-}
\ No newline at end of file
+    uint64toBytes(desfinalPermute(block), plaintext);
+}
+
+void keySchedule3(des3keySchedule *ks, const uint8_t *key) {
+    for (int s = 0; s < 3; s++) {
+        keySchedule(&ks->stages[s], key + s * DES_BLOCK_SIZE);
+    }
+}
+
+void keyscheduleCached3(des3keySchedule *ks, const uint8_t *key) {
+    for (int s = 0; s < 3; s++) {
+        keyscheduleCached(&ks->stages[s], key + s * DES_BLOCK_SIZE);
+    }
+}
+
+// every stage leaves its block right before FP and the next one starts right after
+// IP, and FP(IP(x)) = x, so the stages just hand the permuted block over
+uint64_t des3encryptPermuted(const des3keySchedule *ks, uint64_t block) {
+
+    block = desencryptPermuted(&ks->stages[0], block);
+    block = desdecryptPermuted(&ks->stages[1], block);
+
+    return desencryptPermuted(&ks->stages[2], block);
+}
+
+uint64_t des3decryptPermuted(const des3keySchedule *ks, uint64_t block) {
+
+    block = desdecryptPermuted(&ks->stages[2], block);
+    block = desencryptPermuted(&ks->stages[1], block);
+
+    return desdecryptPermuted(&ks->stages[0], block);
+}
+
+void des3encryptBlock(const des3keySchedule *ks, const uint8_t *plaintext, uint8_t *ciphertext) {
+
+    uint64_t block = desinitialPermute(bytestoUint64(plaintext));
+
+    block = des3encryptPermuted(ks, block);
+
+    uint64toBytes(desfinalPermute(block), ciphertext);
+}
+
+void des3decryptBlock(const des3keySchedule *ks, const uint8_t *ciphertext, uint8_t *plaintext) {
+
+    uint64_t block = desinitialPermute(bytestoUint64(ciphertext));
+
+    block = des3decryptPermuted(ks, block);
+
+    uint64toBytes(desfinalPermute(block), plaintext);
+}
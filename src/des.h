@@ -9,13 +9,67 @@
 typedef struct {
     // 16 48 bit round keys
     uint64_t roundKeys[16];
+    // same round keys pre-split for the SP-box feistel: [0] holds the 6 bit chunks
+    // for S-boxes 1,3,5,7 and [1] for S-boxes 2,4,6,8, one chunk per byte
+    uint32_t splitKeys[16][2];
+    // the key itself (as loaded by bytestoUint64), the bitsliced engine derives
+    // round keys for many different keys at once straight from it
+    uint64_t key;
 } deskeySchedule;
 
 void keySchedule(deskeySchedule *ks, const uint8_t *key);
 
+// same result as keySchedule, but recently used keys are copied from a small shared
+// cache instead of being scheduled again, safe to call from any thread
+void keyscheduleCached(deskeySchedule *ks, const uint8_t *key);
+// wipe every cached schedule (e.g. once an election is tallied)
+void keyschedulecacheClear(void);
+
+// IP and FP (IP^-1) on a block loaded with bytestoUint64
+uint64_t desinitialPermute(uint64_t block);
+uint64_t desfinalPermute(uint64_t block);
+
+// the 16 rounds only, block is already in the IP domain and the result is left
+// before FP, so chained modes can stay permuted between blocks
+uint64_t desencryptPermuted(const deskeySchedule *ks, uint64_t block);
+uint64_t desdecryptPermuted(const deskeySchedule *ks, uint64_t block);
+
 void desencryptBlock(const deskeySchedule *ks, const uint8_t *plaintext, uint8_t *ciphertext);
 void desdecryptBlock(const deskeySchedule *ks, const uint8_t *ciphertext, uint8_t *plaintext);
 
+// bulk ECB over independent blocks, large counts go through the bitsliced engine
+// (desBitslice.c), in and out may be the same buffer
+void desencryptBlocks(const deskeySchedule *ks, const uint8_t *plaintext, uint8_t *ciphertext,
+                      size_t blocks);
+void desdecryptBlocks(const deskeySchedule *ks, const uint8_t *ciphertext, uint8_t *plaintext,
+                      size_t blocks);
+
+// 3DES in EDE3 form, C = E_k3(D_k2(E_k1(P))) with a 24 byte key k1 || k2 || k3
+#define DES3_KEY_SIZE 24
+
+typedef struct {
+    deskeySchedule stages[3];
+} des3keySchedule;
+
+void keySchedule3(des3keySchedule *ks, const uint8_t *key);
+// keySchedule3 through the key schedule cache
+void keyscheduleCached3(des3keySchedule *ks, const uint8_t *key);
+
+// the three stages run back to back in the IP domain (the FP of one stage and the
+// IP of the next cancel out), so a block is 48 rounds with a single IP and FP
+uint64_t des3encryptPermuted(const des3keySchedule *ks, uint64_t block);
+uint64_t des3decryptPermuted(const des3keySchedule *ks, uint64_t block);
+
+void des3encryptBlock(const des3keySchedule *ks, const uint8_t *plaintext, uint8_t *ciphertext);
+void des3decryptBlock(const des3keySchedule *ks, const uint8_t *ciphertext, uint8_t *plaintext);
+void des3encryptBlocks(const des3keySchedule *ks, const uint8_t *plaintext, uint8_t *ciphertext,
+                       size_t blocks);
+void des3decryptBlocks(const des3keySchedule *ks, const uint8_t *ciphertext, uint8_t *plaintext,
+                       size_t blocks);
+
+// every function below (and the block functions above) works in place, the output
+// may be the very same buffer as the input but must not partially overlap it
+// (cbcUpdate/ctsUpdate are the exception, they buffer and need separate buffers)
 void cbcEncrypt(const deskeySchedule *ks, const uint8_t *iv,
                     const uint8_t *plaintext, uint8_t *ciphertext,
                     size_t length);
@@ -23,6 +77,62 @@ void cbcDecrypt(const deskeySchedule *ks, const uint8_t *iv,
                     const uint8_t *ciphertext, uint8_t *plaintext,
                     size_t length);
 
+// cbcDecrypt split in chunks over the worker pool (threadPool.c), cbcDecrypt
+// switches to it by itself for large buffers, plaintext may be ciphertext
+void cbcdecryptParallel(const deskeySchedule *ks, const uint8_t *iv,
+                        const uint8_t *ciphertext, uint8_t *plaintext,
+                        size_t length);
+
+// incremental CBC / CTS for messages that do not fit in (or arrive as) one buffer
+// Update only outputs whole blocks and keeps the rest (CTS holds the last 9..16
+// bytes back for the stealing), Final outputs what is left
+typedef struct {
+    const deskeySchedule *ks;
+    // previous ciphertext block, the IV of whatever comes next
+    uint8_t chain[DES_BLOCK_SIZE];
+    uint8_t buffer[2 * DES_BLOCK_SIZE];
+    size_t buffered;
+    int decrypt;
+    int stealing;
+} cbcContext;
+
+void cbcInit(cbcContext *ctx, const deskeySchedule *ks, const uint8_t *iv, int decrypt);
+void ctsInit(cbcContext *ctx, const deskeySchedule *ks, const uint8_t *iv, int decrypt);
+
+// returns the number of bytes written to output, which needs room for length + 16
+// bytes and must not overlap input
+size_t cbcUpdate(cbcContext *ctx, const uint8_t *input, size_t length, uint8_t *output);
+size_t ctsUpdate(cbcContext *ctx, const uint8_t *input, size_t length, uint8_t *output);
+
+// output needs room for 16 bytes, fails if the message length does not fit the mode
+// (CBC: not a multiple of the block size, CTS: shorter than one block)
+int cbcFinal(cbcContext *ctx, uint8_t *output, size_t *written);
+int ctsFinal(cbcContext *ctx, uint8_t *output, size_t *written);
+
+// counter mode, offset is the position (in bytes) of the first input byte in the
+// message, so any part of it can be processed on its own. No padding, the output
+// is as long as the input and the two may be the same buffer
+void ctrEncrypt(const deskeySchedule *ks, const uint8_t *iv, uint64_t offset,
+                const uint8_t *plaintext, uint8_t *ciphertext, size_t length);
+void ctrDecrypt(const deskeySchedule *ks, const uint8_t *iv, uint64_t offset,
+                const uint8_t *ciphertext, uint8_t *plaintext, size_t length);
+
+// one independent CBC/CTS message for the multi stream functions below
+typedef struct {
+    const deskeySchedule *ks;
+    const uint8_t *iv;
+    const uint8_t *plaintext;
+    uint8_t *ciphertext;
+    size_t length;
+} desStream;
+
+// encrypt many independent messages at once, each with its own key and IV
+// the streams advance in lockstep, one stream per lane of the bitsliced engine
+void cbcencryptStreams(const desStream *streams, size_t count);
+// a stream shorter than a block is skipped (its ciphertext is not written) and
+// reported, EXIT_FAILURE if there was one
+int ctsencryptStreams(const desStream *streams, size_t count);
+
 void ctsEncrypt(const deskeySchedule *ks, const uint8_t *iv,
                        const uint8_t *plaintext, uint8_t *ciphertext,
                        size_t length);
@@ -30,4 +140,18 @@ void ctsDecrypt(const deskeySchedule *ks, const uint8_t *iv,
                        const uint8_t *ciphertext, uint8_t *plaintext,
                        size_t length);
 
+// the same CBC / CTS modes with 3DES
+void des3cbcEncrypt(const des3keySchedule *ks, const uint8_t *iv,
+                    const uint8_t *plaintext, uint8_t *ciphertext,
+                    size_t length);
+void des3cbcDecrypt(const des3keySchedule *ks, const uint8_t *iv,
+                    const uint8_t *ciphertext, uint8_t *plaintext,
+                    size_t length);
+void des3ctsEncrypt(const des3keySchedule *ks, const uint8_t *iv,
+                    const uint8_t *plaintext, uint8_t *ciphertext,
+                    size_t length);
+void des3ctsDecrypt(const des3keySchedule *ks, const uint8_t *iv,
+                    const uint8_t *ciphertext, uint8_t *plaintext,
+                    size_t length);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,238 @@
+#include <string.h>
+#include "constants.h"
+#include "utils.h"
+#include "desBitslice.h"
+#include "desSboxes.h"
+
+/*
+    Bit numbering: slice k is DES bit k + 1 (tables in constants.h are 1 based, MSB
+    first), and block j of lane l lives in bit 63 - j of that lane.
+*/
+
+// 64x64 bit matrix transpose (Hacker's Delight), a[r] bit 63-c <-> a[c] bit 63-r
+static void transpose64(uint64_t a[64]) {
+
+    uint64_t m = 0x00000000FFFFFFFFULL;
+
+    for (int j = 32; j != 0; j >>= 1, m ^= m << j) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            uint64_t t = (a[k] ^ (a[k | j] >> j)) & m;
+            a[k] ^= t;
+            a[k | j] ^= t << j;
+        }
+    }
+}
+
+void bitslicekeysBroadcast(bitsliceKeys *bk, const deskeySchedule *ks) {
+
+    const dsv zero = {0};
+
+    for (int r = 0; r < 16; r++) {
+        for (int b = 0; b < 48; b++) {
+            uint64_t bit = (ks->roundKeys[r] >> (47 - b)) & 1;
+
+            // 0 - 1 gives all ones in every lane, 0 - 0 all zeros
+            bk->keys[r][b] = zero - bit;
+        }
+    }
+}
+
+void bitslicekeysPerBlock(bitsliceKeys *bk, const deskeySchedule *const *schedules, size_t count) {
+
+    // the key schedule only picks and moves bits (PC1, rotations, PC2), so slice the
+    // 64 bit keys once and every round key bit is one of those slices
+    dsv keySlices[64];
+    uint64_t rows[64];
+
+    for (int lane = 0; lane < BITSLICE_LANES; lane++) {
+        for (size_t j = 0; j < 64; j++) {
+            rows[j] = (lane * 64 + j < count) ? schedules[lane * 64 + j]->key : 0;
+        }
+
+        transpose64(rows);
+
+        for (int k = 0; k < 64; k++) {
+            keySlices[k][lane] = rows[k];
+        }
+    }
+
+    int shift = 0;
+
+    for (int r = 0; r < 16; r++) {
+        shift += keyShifts[r];
+
+        for (int b = 0; b < 48; b++) {
+            // bit b of round key r is bit pc2Table[b] of C || D, C and D are the two
+            // halves of the pc1 output rotated left by the shifts so far
+            int c = pc2Table[b] - 1;
+            int j = (c < 28) ? (c + shift) % 28 : 28 + (c - 28 + shift) % 28;
+
+            bk->keys[r][b] = keySlices[pc1Table[j] - 1];
+        }
+    }
+}
+
+// 16 rounds on slices, same shape as desencryptPermuted but 256 blocks at a time
+// target_clones builds an AVX2 and a baseline (SSE2) copy, picked when the program loads
+__attribute__((target_clones("avx2", "default")))
+static void bitsliceRounds(dsv *L, dsv *R, const bitsliceKeys *bk, int decrypt) {
+
+    // sboxPerm inverse: S-box output bit o (0..31) ends up in slice pinv[o]
+    uint8_t pinv[32];
+
+    for (int k = 0; k < 32; k++) {
+        pinv[sboxPerm[k] - 1] = (uint8_t)k;
+    }
+
+    for (int round = 0; round < 16; round++) {
+        const dsv *k = bk->keys[decrypt ? 15 - round : round];
+
+        // expansion is free, just read R through expansionPerm
+        #define SBOX(n) do { \
+            dsv in[6]; \
+            for (int j = 0; j < 6; j++) { \
+                in[j] = R[expansionPerm[(n - 1) * 6 + j] - 1] ^ k[(n - 1) * 6 + j]; \
+            } \
+            bitsliceSbox##n(in, &L[pinv[(n - 1) * 4]], &L[pinv[(n - 1) * 4 + 1]], \
+                            &L[pinv[(n - 1) * 4 + 2]], &L[pinv[(n - 1) * 4 + 3]]); \
+        } while (0)
+
+        // the outputs are xored straight into L, so L becomes the new R
+        SBOX(1); SBOX(2); SBOX(3); SBOX(4);
+        SBOX(5); SBOX(6); SBOX(7); SBOX(8);
+
+        #undef SBOX
+
+        dsv *temp = L;
+        L = R;
+        R = temp;
+    }
+}
+
+void bitsliceCrypt(const bitsliceKeys *bk, size_t stages, const uint64_t *in, uint64_t *out,
+                   size_t count, int decrypt) {
+
+    dsv slices[64];
+    uint64_t rows[64];
+
+    for (int lane = 0; lane < BITSLICE_LANES; lane++) {
+        for (size_t j = 0; j < 64; j++) {
+            rows[j] = (lane * 64 + j < count) ? in[lane * 64 + j] : 0;
+        }
+
+        transpose64(rows);
+
+        for (int k = 0; k < 64; k++) {
+            slices[k][lane] = rows[k];
+        }
+    }
+
+    // IP is just reading the slices in initialPerm order
+    dsv L[32], R[32];
+
+    for (int i = 0; i < 32; i++) {
+        L[i] = slices[initialPerm[i] - 1];
+        R[i] = slices[initialPerm[i + 32] - 1];
+    }
+
+    // 16 is even, so after the rounds the halves are back in L and R, and the final
+    // swap makes R the left half, for the next stage or for FP
+    dsv *left = L, *right = R;
+
+    for (size_t s = 0; s < stages; s++) {
+        // EDE: decryption runs the stages backwards, and every other one inverted
+        size_t stage = decrypt ? stages - 1 - s : s;
+
+        bitsliceRounds(left, right, &bk[stage], decrypt ^ (int)(s & 1));
+
+        dsv *temp = left;
+        left = right;
+        right = temp;
+    }
+
+    // FP (= IP^-1), every half goes back where IP took it from
+    for (int i = 0; i < 32; i++) {
+        slices[initialPerm[i] - 1] = left[i];
+        slices[initialPerm[i + 32] - 1] = right[i];
+    }
+
+    for (int lane = 0; lane < BITSLICE_LANES; lane++) {
+        for (int k = 0; k < 64; k++) {
+            rows[k] = slices[k][lane];
+        }
+
+        transpose64(rows);
+
+        for (size_t j = 0; j < 64 && lane * 64 + j < count; j++) {
+            out[lane * 64 + j] = rows[j];
+        }
+    }
+}
+
+void descryptBlocks(const deskeySchedule *ks, size_t stages, const uint8_t *in, uint8_t *out,
+                    size_t blocks, int decrypt) {
+
+    bitsliceKeys bk[3];
+    uint64_t batch[BITSLICE_BLOCKS];
+    int keysReady = 0;
+
+    while (blocks > 0) {
+        size_t count = blocks < BITSLICE_BLOCKS ? blocks : BITSLICE_BLOCKS;
+
+        // a mostly empty batch costs as much as a full one, so small tails go
+        // through the table driven version
+        if (count < 64) {
+            for (size_t i = 0; i < count; i++) {
+                uint64_t block = desinitialPermute(bytestoUint64(in + i * DES_BLOCK_SIZE));
+
+                block = descryptPermuted(ks, stages, block, decrypt);
+
+                uint64toBytes(desfinalPermute(block), out + i * DES_BLOCK_SIZE);
+            }
+
+            return;
+        }
+
+        if (!keysReady) {
+            for (size_t s = 0; s < stages; s++) {
+                bitslicekeysBroadcast(&bk[s], &ks[s]);
+            }
+
+            keysReady = 1;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            batch[i] = bytestoUint64(in + i * DES_BLOCK_SIZE);
+        }
+
+        bitsliceCrypt(bk, stages, batch, batch, count, decrypt);
+
+        for (size_t i = 0; i < count; i++) {
+            uint64toBytes(batch[i], out + i * DES_BLOCK_SIZE);
+        }
+
+        in += count * DES_BLOCK_SIZE;
+        out += count * DES_BLOCK_SIZE;
+        blocks -= count;
+    }
+}
+
+void desencryptBlocks(const deskeySchedule *ks, const uint8_t *plaintext, uint8_t *ciphertext,
+                      size_t blocks) {
+    descryptBlocks(ks, 1, plaintext, ciphertext, blocks, 0);
+}
+
+void desdecryptBlocks(const deskeySchedule *ks, const uint8_t *ciphertext, uint8_t *plaintext,
+                      size_t blocks) {
+    descryptBlocks(ks, 1, ciphertext, plaintext, blocks, 1);
+}
+
+void des3encryptBlocks(const des3keySchedule *ks, const uint8_t *plaintext, uint8_t *ciphertext,
+                       size_t blocks) {
+    descryptBlocks(ks->stages, 3, plaintext, ciphertext, blocks, 0);
+}
+
+void des3decryptBlocks(const des3keySchedule *ks, const uint8_t *ciphertext, uint8_t *plaintext,
+                       size_t blocks) {
+    descryptBlocks(ks->stages, 3, ciphertext, plaintext, blocks, 1);
+}
@@ -0,0 +1,61 @@
+#ifndef DES_BITSLICE_H
+#define DES_BITSLICE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "des.h"
+
+/*
+    Bitsliced DES, used behind desencryptBlocks/desdecryptBlocks
+
+    The blocks are transposed so slice k holds bit k of every block, one block per
+    bit. Then every permutation (IP, E, P, FP) is only a choice of which slice to
+    read, and the S-boxes are boolean circuits run on whole slices at once
+    (see desSboxes.h). A slice is 4 x 64 bits, so one pass does 256 blocks, the
+    compiler lowers it to AVX2 or SSE2 and we pick the AVX2 clone at runtime.
+*/
+
+#define BITSLICE_LANES 4
+#define BITSLICE_BLOCKS (64 * BITSLICE_LANES)
+
+typedef uint64_t dsv __attribute__((vector_size(8 * BITSLICE_LANES)));
+
+// round keys in slice form, bit j of keys[r][b] is bit b of round key r for block j
+typedef struct {
+    dsv keys[16][48];
+} bitsliceKeys;
+
+// same key for every block
+void bitslicekeysBroadcast(bitsliceKeys *bk, const deskeySchedule *ks);
+
+// key of block j is schedules[j]->key, count <= BITSLICE_BLOCKS, the rest use a 0 key
+void bitslicekeysPerBlock(bitsliceKeys *bk, const deskeySchedule *const *schedules, size_t count);
+
+// run up to BITSLICE_BLOCKS blocks (as loaded by bytestoUint64) through DES
+// (stages = 1) or 3DES (stages = 3, bk[0..2] are the keys of k1, k2, k3)
+// in and out may be the same array
+void bitsliceCrypt(const bitsliceKeys *bk, size_t stages, const uint64_t *in, uint64_t *out,
+                   size_t count, int decrypt);
+
+/*
+    The modes share one code path for DES and 3DES: ks with stages = 1 is a single
+    schedule, stages = 3 means ks is des3keySchedule.stages
+*/
+
+static inline uint64_t descryptPermuted(const deskeySchedule *ks, size_t stages,
+                                        uint64_t block, int decrypt) {
+    if (stages == 1) {
+        return decrypt ? desdecryptPermuted(ks, block) : desencryptPermuted(ks, block);
+    }
+
+    // stages is the first member, so this is the des3keySchedule it came from
+    const des3keySchedule *ks3 = (const des3keySchedule *)ks;
+
+    return decrypt ? des3decryptPermuted(ks3, block) : des3encryptPermuted(ks3, block);
+}
+
+// bulk ECB, what desencryptBlocks and friends run on
+void descryptBlocks(const deskeySchedule *ks, size_t stages, const uint8_t *in, uint8_t *out,
+                    size_t blocks, int decrypt);
+
+#endif
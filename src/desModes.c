@@ -1,68 +1,170 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "des.h"
-
-void cbcEncrypt(const deskeySchedule *ks, const uint8_t *iv,
-                   const uint8_t *plaintext, uint8_t *ciphertext,
-                   size_t length) {
-
-    uint8_t chain[DES_BLOCK_SIZE];
-    uint8_t block[DES_BLOCK_SIZE];
+#include "desBitslice.h"
+#include "threadPool.h"
+#include "utils.h"
+
+/*
+    CBC is run in the IP domain: IP is linear over xor, so
+    IP(P ^ C_prev) = IP(P) ^ IP(C_prev), and IP(C_prev) is exactly the value the
+    previous block had before FP. So the chain never leaves the permuted domain,
+    each block pays one IP on its input and one FP on its output and nothing for
+    the chain itself
+*/
+
+static void cbcencryptStages(const deskeySchedule *ks, size_t stages, const uint8_t *iv,
+                             const uint8_t *plaintext, uint8_t *ciphertext,
+                             size_t length) {
 
     // iv for first chain block
-    memcpy(chain, iv, DES_BLOCK_SIZE);
+    uint64_t chain = desinitialPermute(bytestoUint64(iv));
 
     // if length is 8, then 8/8 = 1, so we loop once
     size_t blockNumber = length / DES_BLOCK_SIZE;
 
     for (size_t i = 0; i < blockNumber; i++) {
-        for (int j = 0; j < DES_BLOCK_SIZE; j++) {
-            // xor plaintext with the chain (IV for first block)
-            block[j] = plaintext[i * DES_BLOCK_SIZE + j] ^ chain[j];
-        }
+        // xor plaintext with the chain (IV for first block)
+        uint64_t block = desinitialPermute(bytestoUint64(plaintext + i * DES_BLOCK_SIZE)) ^ chain;
 
-        desencryptBlock(ks, block, ciphertext + i * DES_BLOCK_SIZE);
+        // now update the chain with the current ciphertext block (still permuted)
+        chain = descryptPermuted(ks, stages, block, 0);
 
-        // now update the chain with the current ciphertext block
-        memcpy(chain, ciphertext + i * DES_BLOCK_SIZE, DES_BLOCK_SIZE);
+        uint64toBytes(desfinalPermute(chain), ciphertext + i * DES_BLOCK_SIZE);
     }
 }
 
-void cbcDecrypt(const deskeySchedule *ks, const uint8_t *iv,
-                   const uint8_t *ciphertext, uint8_t *plaintext,
-                   size_t length) {
-    uint8_t chain[DES_BLOCK_SIZE];
-    uint8_t block[DES_BLOCK_SIZE];
+// CBC decryption has no chain on the DES side (P_i = D(C_i) ^ C_i-1), so the blocks
+// can go through the bitsliced engine a batch at a time and get xored afterwards
+static void cbcdecryptBulk(const deskeySchedule *ks, size_t stages, const uint8_t *iv,
+                           const uint8_t *ciphertext, uint8_t *plaintext,
+                           size_t blockNumber) {
+
+    uint8_t decrypted[BITSLICE_BLOCKS * DES_BLOCK_SIZE];
+    uint64_t chain = bytestoUint64(iv);
+
+    for (size_t i = 0; i < blockNumber; i += BITSLICE_BLOCKS) {
+        size_t count = blockNumber - i < BITSLICE_BLOCKS ? blockNumber - i : BITSLICE_BLOCKS;
+
+        descryptBlocks(ks, stages, ciphertext + i * DES_BLOCK_SIZE, decrypted, count, 1);
+
+        for (size_t b = 0; b < count; b++) {
+            // read the ciphertext before writing, plaintext may be the same buffer
+            uint64_t current_cipher = bytestoUint64(ciphertext + (i + b) * DES_BLOCK_SIZE);
 
-    memcpy(chain, iv, DES_BLOCK_SIZE);
+            uint64toBytes(bytestoUint64(decrypted + b * DES_BLOCK_SIZE) ^ chain,
+                          plaintext + (i + b) * DES_BLOCK_SIZE);
+
+            chain = current_cipher;
+        }
+    }
+}
+
+// blocks per task of the parallel modes (64 KiB)
+#define PARALLEL_CHUNK_BLOCKS (32 * BITSLICE_BLOCKS)
+
+typedef struct {
+    const deskeySchedule *ks;
+    size_t stages;
+    const uint8_t *chunkIVs;
+    const uint8_t *ciphertext;
+    uint8_t *plaintext;
+    size_t blockNumber;
+} cbcdecryptJob;
+
+static void cbcdecryptChunk(void *arg, size_t chunk) {
+
+    const cbcdecryptJob *job = (const cbcdecryptJob *)arg;
+    size_t first = chunk * PARALLEL_CHUNK_BLOCKS;
+    size_t count = job->blockNumber - first < PARALLEL_CHUNK_BLOCKS ? job->blockNumber - first
+                                                               : PARALLEL_CHUNK_BLOCKS;
+
+    cbcdecryptBulk(job->ks, job->stages, job->chunkIVs + chunk * DES_BLOCK_SIZE,
+                   job->ciphertext + first * DES_BLOCK_SIZE,
+                   job->plaintext + first * DES_BLOCK_SIZE, count);
+}
+
+static void cbcdecryptChunks(const deskeySchedule *ks, size_t stages, const uint8_t *iv,
+                             const uint8_t *ciphertext, uint8_t *plaintext,
+                             size_t length) {
 
     size_t blockNumber = length / DES_BLOCK_SIZE;
+    size_t chunks = (blockNumber + PARALLEL_CHUNK_BLOCKS - 1) / PARALLEL_CHUNK_BLOCKS;
 
-    for (size_t i = 0; i < blockNumber; i++) {
-        // Save current ciphertext block for chaining
-        uint8_t current_cipher[DES_BLOCK_SIZE];
-        memcpy(current_cipher, ciphertext + i * DES_BLOCK_SIZE, DES_BLOCK_SIZE);
+    if (chunks < 2) {
+        cbcdecryptBulk(ks, stages, iv, ciphertext, plaintext, blockNumber);
+
+        return;
+    }
 
-        desdecryptBlock(ks, current_cipher, block);
+    // every chunk starts from the ciphertext block before it, copy those first
+    // because with plaintext == ciphertext the previous chunk overwrites them
+    uint8_t *chunkIVs = (uint8_t *)malloc(chunks * DES_BLOCK_SIZE);
+
+    if (!chunkIVs) {
+        cbcdecryptBulk(ks, stages, iv, ciphertext, plaintext, blockNumber);
+
+        return;
+    }
+
+    memcpy(chunkIVs, iv, DES_BLOCK_SIZE);
+
+    for (size_t c = 1; c < chunks; c++) {
+        memcpy(chunkIVs + c * DES_BLOCK_SIZE,
+               ciphertext + (c * PARALLEL_CHUNK_BLOCKS - 1) * DES_BLOCK_SIZE, DES_BLOCK_SIZE);
+    }
+
+    cbcdecryptJob job = { ks, stages, chunkIVs, ciphertext, plaintext, blockNumber };
+
+    threadpoolFor(chunks, cbcdecryptChunk, &job);
+
+    free(chunkIVs);
+}
+
+static void cbcdecryptStages(const deskeySchedule *ks, size_t stages, const uint8_t *iv,
+                             const uint8_t *ciphertext, uint8_t *plaintext,
+                             size_t length) {
+
+    size_t blockNumber = length / DES_BLOCK_SIZE;
+
+    // big enough to give every thread a couple of chunks
+    if (blockNumber >= 2 * PARALLEL_CHUNK_BLOCKS && threadpoolSize() > 1) {
+        cbcdecryptChunks(ks, stages, iv, ciphertext, plaintext, length);
+
+        return;
+    }
+
+    if (blockNumber >= BITSLICE_BLOCKS) {
+        cbcdecryptBulk(ks, stages, iv, ciphertext, plaintext, blockNumber);
+
+        return;
+    }
+
+    uint64_t chain = desinitialPermute(bytestoUint64(iv));
+
+    for (size_t i = 0; i < blockNumber; i++) {
+        // Save current ciphertext block (permuted) for chaining
+        uint64_t current_cipher = desinitialPermute(bytestoUint64(ciphertext + i * DES_BLOCK_SIZE));
 
         // XOR with previous ciphertext block (or IV for first block)
-        for (int j = 0; j < DES_BLOCK_SIZE; j++) {
-            plaintext[i * DES_BLOCK_SIZE + j] = block[j] ^ chain[j];
-        }
+        uint64_t block = descryptPermuted(ks, stages, current_cipher, 1) ^ chain;
+
+        uint64toBytes(desfinalPermute(block), plaintext + i * DES_BLOCK_SIZE);
 
         // Update chain for next iteration
-        memcpy(chain, current_cipher, DES_BLOCK_SIZE);
+        chain = current_cipher;
     }
 }
 
-void ctsEncrypt(const deskeySchedule *ks, const uint8_t *iv,
-                       const uint8_t *plaintext, uint8_t *ciphertext,
-                       size_t length) {
+static void ctsencryptStages(const deskeySchedule *ks, size_t stages, const uint8_t *iv,
+                             const uint8_t *plaintext, uint8_t *ciphertext,
+                             size_t length) {
 
     // if length is a multiple of block size
     if (length % DES_BLOCK_SIZE == 0) {
         // use regular cbc
-        cbcEncrypt(ks, iv, plaintext, ciphertext, length);
+        cbcencryptStages(ks, stages, iv, plaintext, ciphertext, length);
 
         return;
     }
@@ -78,7 +180,7 @@ void ctsEncrypt(const deskeySchedule *ks, const uint8_t *iv,
 
     // 1. Encrypt all blocks except the last two using regular CBC mode
     if (blockNumber > 1) {
-        cbcEncrypt(ks, iv, plaintext, ciphertext, (blockNumber - 1) * DES_BLOCK_SIZE);
+        cbcencryptStages(ks, stages, iv, plaintext, ciphertext, (blockNumber - 1) * DES_BLOCK_SIZE);
     }
 
     // 2. Set up the IV for the second to last block
@@ -101,7 +203,7 @@ void ctsEncrypt(const deskeySchedule *ks, const uint8_t *iv,
     }
 
     // Encrypt the XORed block
-    desencryptBlock(ks, block_n_1, cipher_n_1);
+    descryptBlocks(ks, stages, block_n_1, cipher_n_1, 1, 0);
 
     // 4. Create the last block (padded with zeros)
     uint8_t block_n[DES_BLOCK_SIZE];  // last block
@@ -115,7 +217,7 @@ void ctsEncrypt(const deskeySchedule *ks, const uint8_t *iv,
 
     // 6. Encrypt the last block
     uint8_t cipher_n[DES_BLOCK_SIZE]; // last ciphertext
-    desencryptBlock(ks, block_n, cipher_n);
+    descryptBlocks(ks, stages, block_n, cipher_n, 1, 0);
 
     // 7. Ciphertext stealing: the last block is truncated to the same size as the partial plaintext
     // block, and the second-to-last ciphertext is modified to include the remaining bytes
@@ -127,12 +229,12 @@ void ctsEncrypt(const deskeySchedule *ks, const uint8_t *iv,
     memcpy(ciphertext + blockNumber * DES_BLOCK_SIZE, cipher_n_1, last_block_size);
 }
 
-void ctsDecrypt(const deskeySchedule *ks, const uint8_t *iv,
-                       const uint8_t *ciphertext, uint8_t *plaintext,
-                       size_t length) {
+static void ctsdecryptStages(const deskeySchedule *ks, size_t stages, const uint8_t *iv,
+                             const uint8_t *ciphertext, uint8_t *plaintext,
+                             size_t length) {
     // If length is a multiple of block size, use regular CBC
     if (length % DES_BLOCK_SIZE == 0) {
-        cbcDecrypt(ks, iv, ciphertext, plaintext, length);
+        cbcdecryptStages(ks, stages, iv, ciphertext, plaintext, length);
         return;
     }
 
@@ -146,23 +248,18 @@ void ctsDecrypt(const deskeySchedule *ks, const uint8_t *iv,
         return;
     }
 
-    // 1. Decrypt all blocks except the last two using regular CBC mode
-    if (blockNumber > 1) {
-        cbcDecrypt(ks, iv, ciphertext, plaintext, (blockNumber - 2) * DES_BLOCK_SIZE);
-    }
+    // 1. Read everything the last two blocks need before any plaintext is written,
+    // plaintext may be the same buffer as ciphertext
 
-    // 2. Set up the IV for the second-to-last block
+    // The IV for the second-to-last block is the last regular ciphertext block (C_{n-2})
     uint8_t prev_cipher[DES_BLOCK_SIZE];
     if (blockNumber > 1) {
-        // Use the last fully decrypted block as the IV
-        memcpy(prev_cipher, ciphertext + (blockNumber - 3) * DES_BLOCK_SIZE, DES_BLOCK_SIZE);
+        memcpy(prev_cipher, ciphertext + (blockNumber - 2) * DES_BLOCK_SIZE, DES_BLOCK_SIZE);
     } else {
         // Use the provided IV
         memcpy(prev_cipher, iv, DES_BLOCK_SIZE);
     }
 
-    // 3. Reconstruct the original ciphertext blocks
-
     // Get the last full ciphertext block (C_n)
     uint8_t cipher_n[DES_BLOCK_SIZE];
     memcpy(cipher_n, ciphertext + (blockNumber - 1) * DES_BLOCK_SIZE, DES_BLOCK_SIZE);
@@ -172,27 +269,493 @@ void ctsDecrypt(const deskeySchedule *ks, const uint8_t *iv,
     memset(cipher_n_1, 0, DES_BLOCK_SIZE);
     memcpy(cipher_n_1, ciphertext + blockNumber * DES_BLOCK_SIZE, last_block_size);
 
-    // 4. Decrypt the last full block (C_n)
+    // 2. Decrypt all blocks except the last two using regular CBC mode
+    // (this is where large messages go parallel / bitsliced)
+    if (blockNumber > 1) {
+        cbcdecryptStages(ks, stages, iv, ciphertext, plaintext, (blockNumber - 1) * DES_BLOCK_SIZE);
+    }
+
+    // 3. Decrypt the last full block (C_n)
     uint8_t temp[DES_BLOCK_SIZE];
-    desdecryptBlock(ks, cipher_n, temp);
+    descryptBlocks(ks, stages, cipher_n, temp, 1, 1);
 
-    // 5. Reconstruct the original last ciphertext block by stealing from the second-to-last
+    // 4. Reconstruct the original last ciphertext block by stealing from the second-to-last
     // The last part of C_{n-1} is taken from the decrypted C_n
     for (size_t i = last_block_size; i < DES_BLOCK_SIZE; i++) {
         cipher_n_1[i] = temp[i];
     }
 
+    // 5. XOR the decrypted last block with the original second-to-last ciphertext to get P_n
+    uint8_t last_plain[DES_BLOCK_SIZE];
+    for (size_t i = 0; i < last_block_size; i++) {
+        last_plain[i] = temp[i] ^ cipher_n_1[i];
+    }
+
     // 6. Decrypt the reconstructed second-to-last block
-    desdecryptBlock(ks, cipher_n_1, temp);
+    descryptBlocks(ks, stages, cipher_n_1, temp, 1, 1);
 
     // 7. XOR with the previous ciphertext block to get P_{n-1}
     for (size_t i = 0; i < DES_BLOCK_SIZE; i++) {
         plaintext[(blockNumber - 1) * DES_BLOCK_SIZE + i] = temp[i] ^ prev_cipher[i];
     }
 
-    // 8. XOR the decrypted last block with the original second-to-last ciphertext to get P_n
-    desdecryptBlock(ks, cipher_n, temp);
-    for (size_t i = 0; i < last_block_size; i++) {
-        plaintext[blockNumber * DES_BLOCK_SIZE + i] = temp[i] ^ cipher_n_1[i];
+    memcpy(plaintext + blockNumber * DES_BLOCK_SIZE, last_plain, last_block_size);
+}
+
+
+/*
+    Public CBC / CTS entry points, DES uses its schedule as a single stage and 3DES
+    passes its three stages to the same code
+*/
+
+void cbcEncrypt(const deskeySchedule *ks, const uint8_t *iv,
+                   const uint8_t *plaintext, uint8_t *ciphertext,
+                   size_t length) {
+    cbcencryptStages(ks, 1, iv, plaintext, ciphertext, length);
+}
+
+void cbcDecrypt(const deskeySchedule *ks, const uint8_t *iv,
+                   const uint8_t *ciphertext, uint8_t *plaintext,
+                   size_t length) {
+    cbcdecryptStages(ks, 1, iv, ciphertext, plaintext, length);
+}
+
+void cbcdecryptParallel(const deskeySchedule *ks, const uint8_t *iv,
+                        const uint8_t *ciphertext, uint8_t *plaintext,
+                        size_t length) {
+    cbcdecryptChunks(ks, 1, iv, ciphertext, plaintext, length);
+}
+
+void ctsEncrypt(const deskeySchedule *ks, const uint8_t *iv,
+                       const uint8_t *plaintext, uint8_t *ciphertext,
+                       size_t length) {
+    ctsencryptStages(ks, 1, iv, plaintext, ciphertext, length);
+}
+
+void ctsDecrypt(const deskeySchedule *ks, const uint8_t *iv,
+                       const uint8_t *ciphertext, uint8_t *plaintext,
+                       size_t length) {
+    ctsdecryptStages(ks, 1, iv, ciphertext, plaintext, length);
+}
+
+void des3cbcEncrypt(const des3keySchedule *ks, const uint8_t *iv,
+                    const uint8_t *plaintext, uint8_t *ciphertext,
+                    size_t length) {
+    cbcencryptStages(ks->stages, 3, iv, plaintext, ciphertext, length);
+}
+
+void des3cbcDecrypt(const des3keySchedule *ks, const uint8_t *iv,
+                    const uint8_t *ciphertext, uint8_t *plaintext,
+                    size_t length) {
+    cbcdecryptStages(ks->stages, 3, iv, ciphertext, plaintext, length);
+}
+
+void des3ctsEncrypt(const des3keySchedule *ks, const uint8_t *iv,
+                    const uint8_t *plaintext, uint8_t *ciphertext,
+                    size_t length) {
+    ctsencryptStages(ks->stages, 3, iv, plaintext, ciphertext, length);
+}
+
+void des3ctsDecrypt(const des3keySchedule *ks, const uint8_t *iv,
+                    const uint8_t *ciphertext, uint8_t *plaintext,
+                    size_t length) {
+    ctsdecryptStages(ks->stages, 3, iv, ciphertext, plaintext, length);
+}
+
+/*
+    Incremental CBC / CTS
+
+    Only whole blocks are chained as they come in, the context keeps the partial
+    block (CBC) or the last one or two blocks (CTS, they are only known to be the
+    last ones in Final) and the previous ciphertext block as the next IV.
+*/
+
+static void contextInit(cbcContext *ctx, const deskeySchedule *ks, const uint8_t *iv,
+                        int decrypt, int stealing) {
+    ctx->ks = ks;
+    memcpy(ctx->chain, iv, DES_BLOCK_SIZE);
+    ctx->buffered = 0;
+    ctx->decrypt = decrypt;
+    ctx->stealing = stealing;
+}
+
+// blocks in a row, continuing the chain
+static void contextBlocks(cbcContext *ctx, const uint8_t *input, uint8_t *output, size_t blocks) {
+
+    size_t length = blocks * DES_BLOCK_SIZE;
+
+    if (ctx->decrypt) {
+        uint8_t next[DES_BLOCK_SIZE];
+        memcpy(next, input + length - DES_BLOCK_SIZE, DES_BLOCK_SIZE);
+
+        cbcDecrypt(ctx->ks, ctx->chain, input, output, length);
+        memcpy(ctx->chain, next, DES_BLOCK_SIZE);
+    } else {
+        cbcEncrypt(ctx->ks, ctx->chain, input, output, length);
+        memcpy(ctx->chain, output + length - DES_BLOCK_SIZE, DES_BLOCK_SIZE);
     }
-}
\ No newline at end of file
+}
+
+static size_t contextUpdate(cbcContext *ctx, const uint8_t *input, size_t length, uint8_t *output) {
+
+    size_t available = ctx->buffered + length;
+    size_t blocks;
+
+    if (ctx->stealing) {
+        // always keep more than one block, at most two
+        blocks = available > 2 * DES_BLOCK_SIZE ? (available - DES_BLOCK_SIZE - 1) / DES_BLOCK_SIZE : 0;
+    } else {
+        blocks = available / DES_BLOCK_SIZE;
+    }
+
+    size_t written = 0;
+
+    // the buffered bytes come first, completed from the input if needed
+    while (blocks > 0 && ctx->buffered > 0) {
+        size_t take = ctx->buffered < DES_BLOCK_SIZE ? DES_BLOCK_SIZE - ctx->buffered : 0;
+
+        memcpy(ctx->buffer + ctx->buffered, input, take);
+        input += take;
+        length -= take;
+
+        contextBlocks(ctx, ctx->buffer, output + written, 1);
+
+        ctx->buffered += take - DES_BLOCK_SIZE;
+        memmove(ctx->buffer, ctx->buffer + DES_BLOCK_SIZE, ctx->buffered);
+
+        written += DES_BLOCK_SIZE;
+        blocks--;
+    }
+
+    // then straight from the input
+    if (blocks > 0) {
+        contextBlocks(ctx, input, output + written, blocks);
+
+        input += blocks * DES_BLOCK_SIZE;
+        length -= blocks * DES_BLOCK_SIZE;
+        written += blocks * DES_BLOCK_SIZE;
+    }
+
+    memcpy(ctx->buffer + ctx->buffered, input, length);
+    ctx->buffered += length;
+
+    return written;
+}
+
+void cbcInit(cbcContext *ctx, const deskeySchedule *ks, const uint8_t *iv, int decrypt) {
+    contextInit(ctx, ks, iv, decrypt, 0);
+}
+
+void ctsInit(cbcContext *ctx, const deskeySchedule *ks, const uint8_t *iv, int decrypt) {
+    contextInit(ctx, ks, iv, decrypt, 1);
+}
+
+size_t cbcUpdate(cbcContext *ctx, const uint8_t *input, size_t length, uint8_t *output) {
+    return contextUpdate(ctx, input, length, output);
+}
+
+size_t ctsUpdate(cbcContext *ctx, const uint8_t *input, size_t length, uint8_t *output) {
+    return contextUpdate(ctx, input, length, output);
+}
+
+int cbcFinal(cbcContext *ctx, uint8_t *output, size_t *written) {
+    (void)output;
+
+    *written = 0;
+
+    if (ctx->buffered != 0) {
+        fprintf(stderr, "CBC message is not a multiple of the block size\n");
+        ctx->buffered = 0;
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int ctsFinal(cbcContext *ctx, uint8_t *output, size_t *written) {
+
+    *written = 0;
+
+    if (ctx->buffered == 0) {
+        return EXIT_SUCCESS;
+    }
+
+    if (ctx->buffered < DES_BLOCK_SIZE) {
+        fprintf(stderr, "Message too short for CTS\n");
+        ctx->buffered = 0;
+
+        return EXIT_FAILURE;
+    }
+
+    // the last 9..16 bytes are the tail of a CTS message whose IV is the chain
+    if (ctx->decrypt) {
+        ctsDecrypt(ctx->ks, ctx->chain, ctx->buffer, output, ctx->buffered);
+    } else {
+        ctsEncrypt(ctx->ks, ctx->chain, ctx->buffer, output, ctx->buffered);
+    }
+
+    *written = ctx->buffered;
+    ctx->buffered = 0;
+
+    return EXIT_SUCCESS;
+}
+
+/*
+    CTR mode
+
+    Block i of the keystream is E(counter + i), where counter is the 8 byte IV read
+    as a big endian number (wrapping at 2^64). Every block is independent, so any
+    offset can be encrypted or decrypted without touching what comes before it, and
+    the keystream is made PARALLEL_CHUNK_BLOCKS at a time on the worker pool.
+    Never reuse a key and IV pair for two different messages.
+*/
+
+typedef struct {
+    const deskeySchedule *ks;
+    uint64_t counter;
+    const uint8_t *input;
+    uint8_t *output;
+    size_t blockNumber;
+} ctrJob;
+
+// xor count full blocks starting at counter with the keystream
+static void ctrBlocks(const deskeySchedule *ks, uint64_t counter,
+                      const uint8_t *input, uint8_t *output, size_t count) {
+
+    bitsliceKeys bk;
+    uint64_t stream[BITSLICE_BLOCKS];
+    int keysReady = 0;
+
+    while (count > 0) {
+        size_t batch = count < BITSLICE_BLOCKS ? count : BITSLICE_BLOCKS;
+
+        for (size_t i = 0; i < batch; i++) {
+            stream[i] = counter + i;
+        }
+
+        // same cut off as desencryptBlocks, a mostly empty batch is not worth it
+        if (batch < 64) {
+            for (size_t i = 0; i < batch; i++) {
+                stream[i] = desfinalPermute(desencryptPermuted(ks, desinitialPermute(stream[i])));
+            }
+        } else {
+            if (!keysReady) {
+                bitslicekeysBroadcast(&bk, ks);
+                keysReady = 1;
+            }
+
+            bitsliceCrypt(&bk, 1, stream, stream, batch, 0);
+        }
+
+        for (size_t i = 0; i < batch; i++) {
+            uint64_t block = bytestoUint64(input + i * DES_BLOCK_SIZE) ^ stream[i];
+            uint64toBytes(block, output + i * DES_BLOCK_SIZE);
+        }
+
+        counter += batch;
+        input += batch * DES_BLOCK_SIZE;
+        output += batch * DES_BLOCK_SIZE;
+        count -= batch;
+    }
+}
+
+static void ctrChunk(void *arg, size_t chunk) {
+
+    const ctrJob *job = (const ctrJob *)arg;
+    size_t first = chunk * PARALLEL_CHUNK_BLOCKS;
+    size_t count = job->blockNumber - first < PARALLEL_CHUNK_BLOCKS ? job->blockNumber - first
+                                                                    : PARALLEL_CHUNK_BLOCKS;
+
+    ctrBlocks(job->ks, job->counter + first, job->input + first * DES_BLOCK_SIZE,
+              job->output + first * DES_BLOCK_SIZE, count);
+}
+
+// xor the keystream bytes [start, start + length) of one block into output
+static void ctrPartial(const deskeySchedule *ks, uint64_t counter, size_t start,
+                       const uint8_t *input, uint8_t *output, size_t length) {
+
+    uint8_t stream[DES_BLOCK_SIZE];
+    uint64toBytes(desfinalPermute(desencryptPermuted(ks, desinitialPermute(counter))), stream);
+
+    for (size_t i = 0; i < length; i++) {
+        output[i] = input[i] ^ stream[start + i];
+    }
+}
+
+void ctrEncrypt(const deskeySchedule *ks, const uint8_t *iv, uint64_t offset,
+                const uint8_t *plaintext, uint8_t *ciphertext, size_t length) {
+
+    uint64_t counter = bytestoUint64(iv) + offset / DES_BLOCK_SIZE;
+    size_t start = offset % DES_BLOCK_SIZE;
+
+    // offset in the middle of a block, finish that block first
+    if (start > 0 && length > 0) {
+        size_t head = DES_BLOCK_SIZE - start < length ? DES_BLOCK_SIZE - start : length;
+
+        ctrPartial(ks, counter, start, plaintext, ciphertext, head);
+
+        counter++;
+        plaintext += head;
+        ciphertext += head;
+        length -= head;
+    }
+
+    size_t blockNumber = length / DES_BLOCK_SIZE;
+    size_t chunks = (blockNumber + PARALLEL_CHUNK_BLOCKS - 1) / PARALLEL_CHUNK_BLOCKS;
+
+    ctrJob job = { ks, counter, plaintext, ciphertext, blockNumber };
+
+    if (chunks > 1) {
+        threadpoolFor(chunks, ctrChunk, &job);
+    } else {
+        ctrBlocks(ks, counter, plaintext, ciphertext, blockNumber);
+    }
+
+    size_t remainder = length % DES_BLOCK_SIZE;
+
+    if (remainder > 0) {
+        size_t done = blockNumber * DES_BLOCK_SIZE;
+
+        ctrPartial(ks, counter + blockNumber, 0, plaintext + done, ciphertext + done, remainder);
+    }
+}
+
+void ctrDecrypt(const deskeySchedule *ks, const uint8_t *iv, uint64_t offset,
+                const uint8_t *ciphertext, uint8_t *plaintext, size_t length) {
+    // xoring the same keystream again
+    ctrEncrypt(ks, iv, offset, ciphertext, plaintext, length);
+}
+
+/*
+    Multi stream CBC: every ballot is its own CBC chain, so one chain is serial but
+    different chains are not. Up to BITSLICE_BLOCKS streams are packed into the
+    lanes of the bitsliced engine (each lane gets its own key) and step i encrypts
+    block i of every stream at once.
+
+    CTS with a partial last block is CBC over the zero padded message with the last
+    two ciphertext blocks swapped and the last one cut, so the same loop does both.
+*/
+static void cbcencryptLanes(const desStream *streams, size_t count, int stealing) {
+
+    const deskeySchedule *schedules[BITSLICE_BLOCKS];
+    uint64_t chain[BITSLICE_BLOCKS];
+    uint64_t stolen[BITSLICE_BLOCKS];
+    uint64_t blocks[BITSLICE_BLOCKS];
+    size_t steps = 0;
+
+    for (size_t s = 0; s < count; s++) {
+        schedules[s] = streams[s].ks;
+        chain[s] = bytestoUint64(streams[s].iv);
+
+        size_t n = stealing ? (streams[s].length + DES_BLOCK_SIZE - 1) / DES_BLOCK_SIZE
+                            : streams[s].length / DES_BLOCK_SIZE;
+
+        if (n > steps) {
+            steps = n;
+        }
+    }
+
+    bitsliceKeys bk;
+    bitslicekeysPerBlock(&bk, schedules, count);
+
+    for (size_t i = 0; i < steps; i++) {
+        size_t offset = i * DES_BLOCK_SIZE;
+
+        for (size_t s = 0; s < count; s++) {
+            size_t length = streams[s].length;
+
+            if (offset + DES_BLOCK_SIZE <= length) {
+                blocks[s] = bytestoUint64(streams[s].plaintext + offset) ^ chain[s];
+            } else if (stealing && offset < length) {
+                // last partial block, padded with zeros
+                uint8_t block_n[DES_BLOCK_SIZE] = {0};
+                memcpy(block_n, streams[s].plaintext + offset, length - offset);
+                blocks[s] = bytestoUint64(block_n) ^ chain[s];
+            } else {
+                // this stream is done, the lane just idles
+                blocks[s] = 0;
+            }
+        }
+
+        bitsliceCrypt(&bk, 1, blocks, blocks, count, 0);
+
+        for (size_t s = 0; s < count; s++) {
+            size_t length = streams[s].length;
+            uint8_t *ciphertext = streams[s].ciphertext;
+
+            if (offset >= length || (!stealing && offset + DES_BLOCK_SIZE > length)) {
+                continue;
+            }
+
+            chain[s] = blocks[s];
+
+            int partial = stealing && length % DES_BLOCK_SIZE != 0;
+
+            if (partial && offset + 2 * DES_BLOCK_SIZE > length && offset + DES_BLOCK_SIZE <= length) {
+                // C_n-1, held back until C_n is known
+                stolen[s] = blocks[s];
+            } else if (partial && offset + DES_BLOCK_SIZE > length) {
+                // C_n goes in the full slot, the front of C_n-1 in the partial one
+                uint8_t cipher_n_1[DES_BLOCK_SIZE];
+                uint64toBytes(stolen[s], cipher_n_1);
+
+                uint64toBytes(blocks[s], ciphertext + offset - DES_BLOCK_SIZE);
+                memcpy(ciphertext + offset, cipher_n_1, length - offset);
+            } else {
+                uint64toBytes(blocks[s], ciphertext + offset);
+            }
+        }
+    }
+}
+
+static void encryptStreams(const desStream *streams, size_t count, int stealing) {
+
+    while (count > 0) {
+        size_t group = count < BITSLICE_BLOCKS ? count : BITSLICE_BLOCKS;
+
+        if (group < 64) {
+            // not enough streams to pay for the transposes, do them one by one
+            for (size_t s = 0; s < group; s++) {
+                if (stealing) {
+                    ctsEncrypt(streams[s].ks, streams[s].iv, streams[s].plaintext,
+                               streams[s].ciphertext, streams[s].length);
+                } else {
+                    cbcEncrypt(streams[s].ks, streams[s].iv, streams[s].plaintext,
+                               streams[s].ciphertext, streams[s].length);
+                }
+            }
+        } else {
+            cbcencryptLanes(streams, group, stealing);
+        }
+
+        streams += group;
+        count -= group;
+    }
+}
+
+void cbcencryptStreams(const desStream *streams, size_t count) {
+    encryptStreams(streams, count, 0);
+}
+
+int ctsencryptStreams(const desStream *streams, size_t count) {
+
+    int result = EXIT_SUCCESS;
+    size_t start = 0;
+
+    // same rule as ctsEncrypt, there is nothing to steal from without a full block,
+    // such a stream is left out and the ones around it are still encrypted
+    for (size_t s = 0; s < count; s++) {
+        if (streams[s].length < DES_BLOCK_SIZE) {
+            fprintf(stderr, "Message too short for CTS (stream %zu)\n", s);
+
+            encryptStreams(streams + start, s - start, 1);
+            start = s + 1;
+            result = EXIT_FAILURE;
+        }
+    }
+
+    encryptStreams(streams + start, count - start, 1);
+
+    return result;
+}
@@ -0,0 +1,868 @@
+// generated by helpers/bitslice-sboxes.c, do not edit
+// bitsliced DES S-boxes, each bit of a slice is the same bit of a different block
+// in[0..5] are the S-box inputs (in[0] is the first bit), the 4 outputs are xored
+// into out1..out4 (out1 is the first output bit)
+
+#ifndef DES_SBOXES_H
+#define DES_SBOXES_H
+
+// expects dsv, the slice type, to be defined before this file is included
+
+// s1, 107 gates
+static inline void bitsliceSbox1(const dsv *in, dsv *out1, dsv *out2, dsv *out3, dsv *out4) {
+    dsv a1 = in[0], a2 = in[1], a3 = in[2], a4 = in[3], a5 = in[4], a6 = in[5];
+    dsv x6 = ~a5;
+    dsv x7 = a2 ^ x6;
+    dsv x8 = x7 ^ a5;
+    dsv x9 = a3 & x8;
+    dsv x10 = x7 ^ x9;
+    dsv x11 = a3 & a5;
+    dsv x12 = x7 ^ x11;
+    dsv x13 = x10 ^ x12;
+    dsv x14 = a4 & x13;
+    dsv x15 = x10 ^ x14;
+    dsv x16 = ~x10;
+    dsv x17 = a3 & x6;
+    dsv x18 = a2 ^ x17;
+    dsv x19 = x16 ^ x18;
+    dsv x20 = a4 & x19;
+    dsv x21 = x16 ^ x20;
+    dsv x22 = x15 ^ x21;
+    dsv x23 = a6 & x22;
+    dsv x24 = x15 ^ x23;
+    dsv x25 = x8 | x6;
+    dsv x27 = x25 ^ x17;
+    dsv x28 = x18 ^ x27;
+    dsv x29 = a4 & x28;
+    dsv x30 = x18 ^ x29;
+    dsv x31 = ~x7;
+    dsv x32 = x28 ^ x31;
+    dsv x33 = a3 & x32;
+    dsv x34 = x28 ^ x33;
+    dsv x35 = ~x25;
+    dsv x36 = x7 ^ x35;
+    dsv x37 = a3 & x36;
+    dsv x38 = x7 ^ x37;
+    dsv x39 = x34 ^ x38;
+    dsv x40 = a4 & x39;
+    dsv x41 = x34 ^ x40;
+    dsv x42 = x30 ^ x41;
+    dsv x43 = a6 & x42;
+    dsv x44 = x30 ^ x43;
+    dsv x45 = x24 ^ x44;
+    dsv x46 = a1 & x45;
+    dsv x47 = x24 ^ x46;
+    dsv x48 = ~x18;
+    dsv x49 = x32 ^ x17;
+    dsv x50 = x48 ^ x49;
+    dsv x51 = a4 & x50;
+    dsv x52 = x48 ^ x51;
+    dsv x53 = a5 ^ x9;
+    dsv x54 = a3 & x31;
+    dsv x55 = x25 ^ x54;
+    dsv x56 = a4 & x49;
+    dsv x57 = x53 ^ x56;
+    dsv x58 = x52 ^ x57;
+    dsv x59 = a6 & x58;
+    dsv x60 = x52 ^ x59;
+    dsv x61 = a3 & x50;
+    dsv x62 = x32 ^ x61;
+    dsv x63 = ~x28;
+    dsv x64 = x7 ^ x33;
+    dsv x65 = x62 ^ x64;
+    dsv x66 = a4 & x65;
+    dsv x67 = x62 ^ x66;
+    dsv x68 = a4 ^ x55;
+    dsv x69 = x67 ^ x68;
+    dsv x70 = a6 & x69;
+    dsv x71 = x67 ^ x70;
+    dsv x72 = x60 ^ x71;
+    dsv x73 = a1 & x72;
+    dsv x74 = x60 ^ x73;
+    dsv x76 = a4 & x10;
+    dsv x77 = x62 ^ x76;
+    dsv x78 = x50 ^ x33;
+    dsv x79 = a4 & x25;
+    dsv x80 = x78 ^ x79;
+    dsv x81 = x77 ^ x80;
+    dsv x82 = a6 & x81;
+    dsv x83 = x77 ^ x82;
+    dsv x84 = x63 ^ x11;
+    dsv x85 = a4 & x32;
+    dsv x86 = x84 ^ x85;
+    dsv x89 = a4 & x27;
+    dsv x90 = x64 ^ x89;
+    dsv x91 = x86 ^ x90;
+    dsv x92 = a6 & x91;
+    dsv x93 = x86 ^ x92;
+    dsv x94 = x83 ^ x93;
+    dsv x95 = a1 & x94;
+    dsv x96 = x83 ^ x95;
+    dsv x97 = x8 ^ x11;
+    dsv x98 = x84 ^ x79;
+    dsv x99 = ~x62;
+    dsv x101 = x99 ^ x29;
+    dsv x102 = x98 ^ x101;
+    dsv x103 = a6 & x102;
+    dsv x104 = x98 ^ x103;
+    dsv x105 = ~x97;
+    dsv x106 = x16 ^ x105;
+    dsv x107 = a4 & x106;
+    dsv x108 = x16 ^ x107;
+    dsv x109 = a3 ^ x32;
+    dsv x111 = a4 & x7;
+    dsv x112 = x109 ^ x111;
+    dsv x113 = x108 ^ x112;
+    dsv x114 = a6 & x113;
+    dsv x115 = x108 ^ x114;
+    dsv x116 = x104 ^ x115;
+    dsv x117 = a1 & x116;
+    dsv x118 = x104 ^ x117;
+    *out1 ^= x47;
+    *out2 ^= x74;
+    *out3 ^= x96;
+    *out4 ^= x118;
+}
+
+// s2, 100 gates
+static inline void bitsliceSbox2(const dsv *in, dsv *out1, dsv *out2, dsv *out3, dsv *out4) {
+    dsv a1 = in[0], a2 = in[1], a3 = in[2], a4 = in[3], a5 = in[4], a6 = in[5];
+    dsv x6 = ~a5;
+    dsv x7 = a3 ^ x6;
+    dsv x8 = a6 ^ x7;
+    dsv x9 = ~a3;
+    dsv x11 = a4 & a5;
+    dsv x12 = x8 ^ x11;
+    dsv x13 = ~x7;
+    dsv x14 = x9 | a5;
+    dsv x15 = x13 ^ x14;
+    dsv x16 = a6 & x15;
+    dsv x17 = x13 ^ x16;
+    dsv x18 = x6 & ~a3;
+    dsv x19 = x13 ^ x18;
+    dsv x20 = a6 & x19;
+    dsv x21 = x13 ^ x20;
+    dsv x22 = x17 ^ x21;
+    dsv x23 = a4 & x22;
+    dsv x24 = x17 ^ x23;
+    dsv x25 = x12 ^ x24;
+    dsv x26 = a1 & x25;
+    dsv x27 = x12 ^ x26;
+    dsv x28 = a6 & a3;
+    dsv x29 = x6 ^ x28;
+    dsv x30 = a4 ^ x29;
+    dsv x31 = a4 ^ x21;
+    dsv x32 = x30 ^ x31;
+    dsv x33 = a1 & x32;
+    dsv x34 = x30 ^ x33;
+    dsv x35 = x27 ^ x34;
+    dsv x36 = a2 & x35;
+    dsv x37 = x27 ^ x36;
+    dsv x38 = a6 & x9;
+    dsv x39 = x6 ^ x38;
+    dsv x40 = a6 & x18;
+    dsv x41 = a5 ^ x40;
+    dsv x42 = x39 ^ x41;
+    dsv x43 = a4 & x42;
+    dsv x44 = x39 ^ x43;
+    dsv x45 = a1 ^ x44;
+    dsv x46 = x13 ^ x38;
+    dsv x47 = ~x19;
+    dsv x51 = a4 & x16;
+    dsv x52 = x46 ^ x51;
+    dsv x53 = a6 & x14;
+    dsv x54 = x18 ^ x53;
+    dsv x55 = x14 ^ x28;
+    dsv x56 = x54 ^ x55;
+    dsv x57 = a4 & x56;
+    dsv x58 = x54 ^ x57;
+    dsv x59 = x52 ^ x58;
+    dsv x60 = a1 & x59;
+    dsv x61 = x52 ^ x60;
+    dsv x62 = x45 ^ x61;
+    dsv x63 = a2 & x62;
+    dsv x64 = x45 ^ x63;
+    dsv x66 = a4 & x55;
+    dsv x67 = x15 ^ x66;
+    dsv x68 = x13 ^ x22;
+    dsv x70 = a4 & x6;
+    dsv x71 = x68 ^ x70;
+    dsv x72 = x67 ^ x71;
+    dsv x73 = a1 & x72;
+    dsv x74 = x67 ^ x73;
+    dsv x75 = ~x15;
+    dsv x76 = ~x14;
+    dsv x77 = a6 & x13;
+    dsv x78 = x75 ^ x77;
+    dsv x79 = x78 ^ x8;
+    dsv x80 = a4 & x79;
+    dsv x81 = x78 ^ x80;
+    dsv x82 = x47 ^ x53;
+    dsv x84 = a4 & x13;
+    dsv x85 = x82 ^ x84;
+    dsv x86 = x81 ^ x85;
+    dsv x87 = a1 & x86;
+    dsv x88 = x81 ^ x87;
+    dsv x89 = x74 ^ x88;
+    dsv x90 = a2 & x89;
+    dsv x91 = x74 ^ x90;
+    dsv x92 = x76 ^ x77;
+    dsv x93 = x55 ^ x92;
+    dsv x94 = a4 & x93;
+    dsv x95 = x55 ^ x94;
+    dsv x96 = a4 ^ x16;
+    dsv x97 = x95 ^ x96;
+    dsv x98 = a1 & x97;
+    dsv x99 = x95 ^ x98;
+    dsv x101 = x32 ^ x70;
+    dsv x102 = a6 & x76;
+    dsv x103 = x15 ^ x102;
+    dsv x104 = x47 ^ x40;
+    dsv x105 = x103 ^ x104;
+    dsv x106 = a4 & x105;
+    dsv x107 = x103 ^ x106;
+    dsv x108 = x101 ^ x107;
+    dsv x109 = a1 & x108;
+    dsv x110 = x101 ^ x109;
+    dsv x111 = x99 ^ x110;
+    dsv x112 = a2 & x111;
+    dsv x113 = x99 ^ x112;
+    *out1 ^= x37;
+    *out2 ^= x64;
+    *out3 ^= x91;
+    *out4 ^= x113;
+}
+
+// s3, 101 gates
+static inline void bitsliceSbox3(const dsv *in, dsv *out1, dsv *out2, dsv *out3, dsv *out4) {
+    dsv a1 = in[0], a2 = in[1], a3 = in[2], a4 = in[3], a5 = in[4], a6 = in[5];
+    dsv x6 = ~a5;
+    dsv x7 = a2 ^ x6;
+    dsv x8 = x6 | a6;
+    dsv x9 = a2 & x8;
+    dsv x10 = x7 ^ x9;
+    dsv x11 = a3 & x10;
+    dsv x12 = x7 ^ x11;
+    dsv x13 = ~a6;
+    dsv x14 = a5 | x13;
+    dsv x15 = a5 ^ x13;
+    dsv x16 = x14 ^ x15;
+    dsv x17 = a2 & x16;
+    dsv x18 = x14 ^ x17;
+    dsv x19 = a2 ^ x15;
+    dsv x20 = x18 ^ x19;
+    dsv x21 = a3 & x20;
+    dsv x22 = x18 ^ x21;
+    dsv x23 = x12 ^ x22;
+    dsv x24 = a4 & x23;
+    dsv x25 = x12 ^ x24;
+    dsv x26 = ~x15;
+    dsv x28 = x15 ^ x21;
+    dsv x29 = a4 ^ x28;
+    dsv x30 = x25 ^ x29;
+    dsv x31 = a1 & x30;
+    dsv x32 = x25 ^ x31;
+    dsv x33 = a6 ^ x16;
+    dsv x34 = a2 & x33;
+    dsv x35 = a6 ^ x34;
+    dsv x36 = x35 ^ x19;
+    dsv x37 = a3 & x36;
+    dsv x38 = x35 ^ x37;
+    dsv x39 = x6 | x13;
+    dsv x41 = a2 & x13;
+    dsv x42 = x39 ^ x41;
+    dsv x43 = x20 ^ x42;
+    dsv x44 = a3 & x43;
+    dsv x45 = x20 ^ x44;
+    dsv x46 = x38 ^ x45;
+    dsv x47 = a4 & x46;
+    dsv x48 = x38 ^ x47;
+    dsv x49 = a2 ^ x13;
+    dsv x51 = a3 & x6;
+    dsv x52 = x49 ^ x51;
+    dsv x53 = x6 ^ x41;
+    dsv x55 = a3 & x8;
+    dsv x56 = x53 ^ x55;
+    dsv x57 = x52 ^ x56;
+    dsv x58 = a4 & x57;
+    dsv x59 = x52 ^ x58;
+    dsv x60 = x48 ^ x59;
+    dsv x61 = a1 & x60;
+    dsv x62 = x48 ^ x61;
+    dsv x63 = x15 ^ x9;
+    dsv x64 = x39 ^ x34;
+    dsv x65 = x63 ^ x64;
+    dsv x66 = a3 & x65;
+    dsv x67 = x63 ^ x66;
+    dsv x68 = x16 ^ a5;
+    dsv x69 = a2 & x68;
+    dsv x70 = x16 ^ x69;
+    dsv x71 = a3 ^ x70;
+    dsv x72 = x67 ^ x71;
+    dsv x73 = a4 & x72;
+    dsv x74 = x67 ^ x73;
+    dsv x75 = ~x53;
+    dsv x76 = x75 ^ x26;
+    dsv x77 = a3 & x76;
+    dsv x78 = x75 ^ x77;
+    dsv x79 = x15 ^ x34;
+    dsv x80 = x9 ^ x79;
+    dsv x81 = a3 & x80;
+    dsv x82 = x9 ^ x81;
+    dsv x83 = x78 ^ x82;
+    dsv x84 = a4 & x83;
+    dsv x85 = x78 ^ x84;
+    dsv x86 = x74 ^ x85;
+    dsv x87 = a1 & x86;
+    dsv x88 = x74 ^ x87;
+    dsv x89 = ~x49;
+    dsv x90 = a3 & a5;
+    dsv x91 = x89 ^ x90;
+    dsv x93 = a4 & x6;
+    dsv x94 = x91 ^ x93;
+    dsv x95 = a2 & x39;
+    dsv x96 = a5 ^ x95;
+    dsv x97 = x43 ^ x96;
+    dsv x98 = a3 & x97;
+    dsv x99 = x43 ^ x98;
+    dsv x100 = ~x79;
+    dsv x101 = a2 & x14;
+    dsv x102 = x15 ^ x101;
+    dsv x103 = x100 ^ x102;
+    dsv x104 = a3 & x103;
+    dsv x105 = x100 ^ x104;
+    dsv x106 = x99 ^ x105;
+    dsv x107 = a4 & x106;
+    dsv x108 = x99 ^ x107;
+    dsv x109 = x94 ^ x108;
+    dsv x110 = a1 & x109;
+    dsv x111 = x94 ^ x110;
+    *out1 ^= x32;
+    *out2 ^= x62;
+    *out3 ^= x88;
+    *out4 ^= x111;
+}
+
+// s4, 71 gates
+static inline void bitsliceSbox4(const dsv *in, dsv *out1, dsv *out2, dsv *out3, dsv *out4) {
+    dsv a1 = in[0], a2 = in[1], a3 = in[2], a4 = in[3], a5 = in[4], a6 = in[5];
+    dsv x6 = ~a4;
+    dsv x7 = a3 ^ x6;
+    dsv x8 = a4 ^ x7;
+    dsv x9 = a5 & x8;
+    dsv x10 = a4 ^ x9;
+    dsv x11 = ~x7;
+    dsv x12 = a5 & a4;
+    dsv x13 = x11 ^ x12;
+    dsv x14 = x10 ^ x13;
+    dsv x15 = a2 & x14;
+    dsv x16 = x10 ^ x15;
+    dsv x17 = x8 | x6;
+    dsv x18 = x17 ^ a3;
+    dsv x19 = a5 & x18;
+    dsv x20 = x17 ^ x19;
+    dsv x22 = x7 ^ x19;
+    dsv x23 = x20 ^ x22;
+    dsv x24 = a2 & x23;
+    dsv x25 = x20 ^ x24;
+    dsv x26 = x16 ^ x25;
+    dsv x27 = a1 & x26;
+    dsv x28 = x16 ^ x27;
+    dsv x29 = a5 & x11;
+    dsv x30 = x8 ^ x29;
+    dsv x33 = a2 & x18;
+    dsv x34 = x30 ^ x33;
+    dsv x35 = a5 & x6;
+    dsv x36 = a3 ^ x35;
+    dsv x37 = a5 ^ x6;
+    dsv x38 = x36 ^ x37;
+    dsv x39 = a2 & x38;
+    dsv x40 = x36 ^ x39;
+    dsv x41 = x34 ^ x40;
+    dsv x42 = a1 & x41;
+    dsv x43 = x34 ^ x42;
+    dsv x44 = x28 ^ x43;
+    dsv x45 = a6 & x44;
+    dsv x46 = x28 ^ x45;
+    dsv x47 = ~x28;
+    dsv x48 = x43 ^ x47;
+    dsv x49 = a6 & x48;
+    dsv x50 = x43 ^ x49;
+    dsv x51 = x8 ^ x23;
+    dsv x52 = a5 & x51;
+    dsv x53 = x8 ^ x52;
+    dsv x56 = a2 & x17;
+    dsv x57 = x53 ^ x56;
+    dsv x58 = a5 & a3;
+    dsv x59 = x7 ^ x58;
+    dsv x60 = ~x36;
+    dsv x61 = x59 ^ x60;
+    dsv x62 = a2 & x61;
+    dsv x63 = x59 ^ x62;
+    dsv x64 = x57 ^ x63;
+    dsv x65 = a1 & x64;
+    dsv x66 = x57 ^ x65;
+    dsv x68 = a2 & x36;
+    dsv x69 = x13 ^ x68;
+    dsv x70 = x6 ^ x29;
+    dsv x71 = a2 & x51;
+    dsv x72 = x70 ^ x71;
+    dsv x73 = x69 ^ x72;
+    dsv x74 = a1 & x73;
+    dsv x75 = x69 ^ x74;
+    dsv x76 = x66 ^ x75;
+    dsv x77 = a6 & x76;
+    dsv x78 = x66 ^ x77;
+    dsv x79 = ~x75;
+    dsv x80 = x79 ^ x66;
+    dsv x81 = a6 & x80;
+    dsv x82 = x79 ^ x81;
+    *out1 ^= x46;
+    *out2 ^= x50;
+    *out3 ^= x78;
+    *out4 ^= x82;
+}
+
+// s5, 109 gates
+static inline void bitsliceSbox5(const dsv *in, dsv *out1, dsv *out2, dsv *out3, dsv *out4) {
+    dsv a1 = in[0], a2 = in[1], a3 = in[2], a4 = in[3], a5 = in[4], a6 = in[5];
+    dsv x6 = a2 ^ a5;
+    dsv x7 = a1 & a5;
+    dsv x8 = x6 ^ x7;
+    dsv x9 = ~a2;
+    dsv x10 = x6 ^ x9;
+    dsv x11 = a1 & x10;
+    dsv x12 = x6 ^ x11;
+    dsv x13 = a3 & a1;
+    dsv x14 = x8 ^ x13;
+    dsv x15 = x9 | a5;
+    dsv x16 = x9 ^ x15;
+    dsv x17 = a1 & x16;
+    dsv x18 = x9 ^ x17;
+    dsv x19 = x16 ^ x6;
+    dsv x20 = a1 & x19;
+    dsv x21 = x16 ^ x20;
+    dsv x22 = x18 ^ x21;
+    dsv x23 = a3 & x22;
+    dsv x24 = x18 ^ x23;
+    dsv x25 = x14 ^ x24;
+    dsv x26 = a6 & x25;
+    dsv x27 = x14 ^ x26;
+    dsv x28 = a2 | x10;
+    dsv x29 = x28 ^ a5;
+    dsv x30 = a1 & x29;
+    dsv x31 = x28 ^ x30;
+    dsv x32 = x21 ^ x31;
+    dsv x33 = a3 & x32;
+    dsv x34 = x21 ^ x33;
+    dsv x35 = ~x6;
+    dsv x36 = x19 ^ x30;
+    dsv x39 = a3 & x15;
+    dsv x40 = x36 ^ x39;
+    dsv x41 = x34 ^ x40;
+    dsv x42 = a6 & x41;
+    dsv x43 = x34 ^ x42;
+    dsv x44 = x27 ^ x43;
+    dsv x45 = a4 & x44;
+    dsv x46 = x27 ^ x45;
+    dsv x47 = a1 ^ a5;
+    dsv x48 = a1 & x9;
+    dsv x49 = x10 ^ x48;
+    dsv x50 = x47 ^ x49;
+    dsv x51 = a3 & x50;
+    dsv x52 = x47 ^ x51;
+    dsv x55 = a3 & x6;
+    dsv x56 = x32 ^ x55;
+    dsv x57 = x52 ^ x56;
+    dsv x58 = a6 & x57;
+    dsv x59 = x52 ^ x58;
+    dsv x60 = ~x12;
+    dsv x61 = a1 ^ x6;
+    dsv x62 = x60 ^ x61;
+    dsv x63 = a3 & x62;
+    dsv x64 = x60 ^ x63;
+    dsv x65 = a6 ^ x64;
+    dsv x66 = x59 ^ x65;
+    dsv x67 = a4 & x66;
+    dsv x68 = x59 ^ x67;
+    dsv x69 = ~x36;
+    dsv x70 = x9 ^ x20;
+    dsv x71 = x69 ^ x70;
+    dsv x72 = a3 & x71;
+    dsv x73 = x69 ^ x72;
+    dsv x74 = x70 ^ x6;
+    dsv x75 = a3 & x74;
+    dsv x76 = x70 ^ x75;
+    dsv x77 = x73 ^ x76;
+    dsv x78 = a6 & x77;
+    dsv x79 = x73 ^ x78;
+    dsv x80 = ~x70;
+    dsv x82 = x80 ^ x39;
+    dsv x83 = a1 ^ x28;
+    dsv x87 = x83 ^ x75;
+    dsv x88 = x82 ^ x87;
+    dsv x89 = a6 & x88;
+    dsv x90 = x82 ^ x89;
+    dsv x91 = x79 ^ x90;
+    dsv x92 = a4 & x91;
+    dsv x93 = x79 ^ x92;
+    dsv x94 = x16 ^ a2;
+    dsv x95 = a1 & x94;
+    dsv x96 = x16 ^ x95;
+    dsv x97 = ~x47;
+    dsv x98 = x96 ^ x97;
+    dsv x99 = a3 & x98;
+    dsv x100 = x96 ^ x99;
+    dsv x102 = a3 & x16;
+    dsv x103 = x61 ^ x102;
+    dsv x104 = x100 ^ x103;
+    dsv x105 = a6 & x104;
+    dsv x106 = x100 ^ x105;
+    dsv x107 = x19 ^ x11;
+    dsv x108 = x35 ^ x17;
+    dsv x109 = x107 ^ x108;
+    dsv x110 = a3 & x109;
+    dsv x111 = x107 ^ x110;
+    dsv x112 = x94 ^ x20;
+    dsv x113 = a1 & x28;
+    dsv x114 = x9 ^ x113;
+    dsv x115 = x112 ^ x114;
+    dsv x116 = a3 & x115;
+    dsv x117 = x112 ^ x116;
+    dsv x118 = x111 ^ x117;
+    dsv x119 = a6 & x118;
+    dsv x120 = x111 ^ x119;
+    dsv x121 = x106 ^ x120;
+    dsv x122 = a4 & x121;
+    dsv x123 = x106 ^ x122;
+    *out1 ^= x46;
+    *out2 ^= x68;
+    *out3 ^= x93;
+    *out4 ^= x123;
+}
+
+// s6, 105 gates
+static inline void bitsliceSbox6(const dsv *in, dsv *out1, dsv *out2, dsv *out3, dsv *out4) {
+    dsv a1 = in[0], a2 = in[1], a3 = in[2], a4 = in[3], a5 = in[4], a6 = in[5];
+    dsv x6 = ~a5;
+    dsv x7 = a2 ^ x6;
+    dsv x8 = ~a2;
+    dsv x9 = a6 & a5;
+    dsv x10 = x7 ^ x9;
+    dsv x11 = a6 ^ x6;
+    dsv x12 = x10 ^ x11;
+    dsv x13 = a3 & x12;
+    dsv x14 = x10 ^ x13;
+    dsv x15 = a6 ^ x8;
+    dsv x16 = a6 & x8;
+    dsv x17 = a5 ^ x16;
+    dsv x18 = x15 ^ x17;
+    dsv x19 = a3 & x18;
+    dsv x20 = x15 ^ x19;
+    dsv x21 = x14 ^ x20;
+    dsv x22 = a4 & x21;
+    dsv x23 = x14 ^ x22;
+    dsv x24 = x6 & ~a2;
+    dsv x25 = a5 ^ x24;
+    dsv x26 = a6 & x25;
+    dsv x27 = a5 ^ x26;
+    dsv x28 = x15 ^ x27;
+    dsv x29 = a3 & x28;
+    dsv x30 = x15 ^ x29;
+    dsv x31 = a5 & ~a2;
+    dsv x32 = x7 ^ x26;
+    dsv x33 = a6 | x6;
+    dsv x34 = x32 ^ x33;
+    dsv x35 = a3 & x34;
+    dsv x36 = x32 ^ x35;
+    dsv x37 = x30 ^ x36;
+    dsv x38 = a4 & x37;
+    dsv x39 = x30 ^ x38;
+    dsv x40 = x23 ^ x39;
+    dsv x41 = a1 & x40;
+    dsv x42 = x23 ^ x41;
+    dsv x43 = a6 ^ x7;
+    dsv x45 = a3 & x6;
+    dsv x46 = x43 ^ x45;
+    dsv x47 = ~x31;
+    dsv x48 = a5 ^ x47;
+    dsv x49 = a6 & x48;
+    dsv x50 = a5 ^ x49;
+    dsv x51 = a3 ^ x50;
+    dsv x52 = x46 ^ x51;
+    dsv x53 = a4 & x52;
+    dsv x54 = x46 ^ x53;
+    dsv x55 = ~x43;
+    dsv x56 = ~x48;
+    dsv x57 = ~x7;
+    dsv x58 = x56 ^ x57;
+    dsv x59 = a6 & x58;
+    dsv x60 = x56 ^ x59;
+    dsv x61 = x55 ^ x60;
+    dsv x62 = a3 & x61;
+    dsv x63 = x55 ^ x62;
+    dsv x64 = a6 & x47;
+    dsv x65 = x48 ^ x64;
+    dsv x66 = x65 ^ x7;
+    dsv x67 = a3 & x66;
+    dsv x68 = x65 ^ x67;
+    dsv x69 = x63 ^ x68;
+    dsv x70 = a4 & x69;
+    dsv x71 = x63 ^ x70;
+    dsv x72 = x54 ^ x71;
+    dsv x73 = a1 & x72;
+    dsv x74 = x54 ^ x73;
+    dsv x76 = a3 & x58;
+    dsv x77 = x49 ^ x76;
+    dsv x80 = x65 ^ x76;
+    dsv x81 = x77 ^ x80;
+    dsv x82 = a4 & x81;
+    dsv x83 = x77 ^ x82;
+    dsv x84 = a6 & x56;
+    dsv x85 = x57 ^ x84;
+    dsv x88 = a3 & x65;
+    dsv x89 = x85 ^ x88;
+    dsv x90 = x7 ^ x88;
+    dsv x91 = x89 ^ x90;
+    dsv x92 = a4 & x91;
+    dsv x93 = x89 ^ x92;
+    dsv x94 = x83 ^ x93;
+    dsv x95 = a1 & x94;
+    dsv x96 = x83 ^ x95;
+    dsv x97 = a3 & x8;
+    dsv x98 = a5 ^ x97;
+    dsv x99 = a6 & x31;
+    dsv x100 = x57 ^ x99;
+    dsv x101 = a2 ^ x26;
+    dsv x102 = x100 ^ x101;
+    dsv x103 = a3 & x102;
+    dsv x104 = x100 ^ x103;
+    dsv x105 = x98 ^ x104;
+    dsv x106 = a4 & x105;
+    dsv x107 = x98 ^ x106;
+    dsv x108 = ~x17;
+    dsv x109 = x108 ^ x19;
+    dsv x110 = x15 ^ x45;
+    dsv x111 = x109 ^ x110;
+    dsv x112 = a4 & x111;
+    dsv x113 = x109 ^ x112;
+    dsv x114 = x107 ^ x113;
+    dsv x115 = a1 & x114;
+    dsv x116 = x107 ^ x115;
+    *out1 ^= x42;
+    *out2 ^= x74;
+    *out3 ^= x96;
+    *out4 ^= x116;
+}
+
+// s7, 99 gates
+static inline void bitsliceSbox7(const dsv *in, dsv *out1, dsv *out2, dsv *out3, dsv *out4) {
+    dsv a1 = in[0], a2 = in[1], a3 = in[2], a4 = in[3], a5 = in[4], a6 = in[5];
+    dsv x6 = a2 ^ a5;
+    dsv x7 = a4 & a2;
+    dsv x8 = a5 ^ x7;
+    dsv x9 = ~x6;
+    dsv x10 = ~a2;
+    dsv x11 = a4 & a5;
+    dsv x12 = x9 ^ x11;
+    dsv x13 = x8 ^ x12;
+    dsv x14 = a3 & x13;
+    dsv x15 = x8 ^ x14;
+    dsv x16 = x10 | a5;
+    dsv x17 = a2 ^ x16;
+    dsv x18 = a4 & x17;
+    dsv x19 = a2 ^ x18;
+    dsv x20 = ~a5;
+    dsv x21 = x20 & ~a2;
+    dsv x22 = x21 ^ x18;
+    dsv x23 = x19 ^ x22;
+    dsv x24 = a3 & x23;
+    dsv x25 = x19 ^ x24;
+    dsv x26 = x15 ^ x25;
+    dsv x27 = a1 & x26;
+    dsv x28 = x15 ^ x27;
+    dsv x29 = ~x8;
+    dsv x30 = a3 ^ x29;
+    dsv x31 = a4 & x23;
+    dsv x32 = x6 ^ x31;
+    dsv x33 = ~x16;
+    dsv x34 = x33 ^ x31;
+    dsv x35 = x32 ^ x34;
+    dsv x36 = a3 & x35;
+    dsv x37 = x32 ^ x36;
+    dsv x38 = x30 ^ x37;
+    dsv x39 = a1 & x38;
+    dsv x40 = x30 ^ x39;
+    dsv x41 = x28 ^ x40;
+    dsv x42 = a6 & x41;
+    dsv x43 = x28 ^ x42;
+    dsv x44 = a4 & x10;
+    dsv x45 = x9 ^ x44;
+    dsv x47 = a3 & a2;
+    dsv x48 = x45 ^ x47;
+    dsv x49 = x48 ^ x15;
+    dsv x50 = a1 & x49;
+    dsv x51 = x48 ^ x50;
+    dsv x52 = ~x21;
+    dsv x53 = a4 & x16;
+    dsv x54 = x20 ^ x53;
+    dsv x56 = a4 & x21;
+    dsv x57 = x9 ^ x56;
+    dsv x58 = x54 ^ x57;
+    dsv x59 = a3 & x58;
+    dsv x60 = x54 ^ x59;
+    dsv x61 = x6 ^ x7;
+    dsv x62 = x9 ^ x61;
+    dsv x63 = a3 & x62;
+    dsv x64 = x9 ^ x63;
+    dsv x65 = x60 ^ x64;
+    dsv x66 = a1 & x65;
+    dsv x67 = x60 ^ x66;
+    dsv x68 = x51 ^ x67;
+    dsv x69 = a6 & x68;
+    dsv x70 = x51 ^ x69;
+    dsv x71 = a3 ^ x32;
+    dsv x72 = a4 & x9;
+    dsv x73 = a2 ^ x72;
+    dsv x75 = a3 & x52;
+    dsv x76 = x73 ^ x75;
+    dsv x77 = x71 ^ x76;
+    dsv x78 = a1 & x77;
+    dsv x79 = x71 ^ x78;
+    dsv x80 = a4 ^ a2;
+    dsv x82 = a3 & x72;
+    dsv x83 = x80 ^ x82;
+    dsv x84 = x10 ^ x53;
+    dsv x85 = a3 ^ x84;
+    dsv x86 = x83 ^ x85;
+    dsv x87 = a1 & x86;
+    dsv x88 = x83 ^ x87;
+    dsv x89 = x79 ^ x88;
+    dsv x90 = a6 & x89;
+    dsv x91 = x79 ^ x90;
+    dsv x92 = ~x12;
+    dsv x93 = a4 ^ x20;
+    dsv x94 = x92 ^ x93;
+    dsv x95 = a3 & x94;
+    dsv x96 = x92 ^ x95;
+    dsv x97 = a1 ^ x96;
+    dsv x98 = a4 & x52;
+    dsv x99 = x9 ^ x98;
+    dsv x101 = x99 ^ x95;
+    dsv x102 = ~x22;
+    dsv x103 = a3 ^ x102;
+    dsv x104 = x101 ^ x103;
+    dsv x105 = a1 & x104;
+    dsv x106 = x101 ^ x105;
+    dsv x107 = x97 ^ x106;
+    dsv x108 = a6 & x107;
+    dsv x109 = x97 ^ x108;
+    *out1 ^= x43;
+    *out2 ^= x70;
+    *out3 ^= x91;
+    *out4 ^= x109;
+}
+
+// s8, 93 gates
+static inline void bitsliceSbox8(const dsv *in, dsv *out1, dsv *out2, dsv *out3, dsv *out4) {
+    dsv a1 = in[0], a2 = in[1], a3 = in[2], a4 = in[3], a5 = in[4], a6 = in[5];
+    dsv x6 = ~a5;
+    dsv x7 = a2 | x6;
+    dsv x8 = a2 ^ x6;
+    dsv x9 = x7 ^ x8;
+    dsv x10 = a4 & x9;
+    dsv x11 = x7 ^ x10;
+    dsv x12 = ~x7;
+    dsv x13 = x12 ^ x6;
+    dsv x14 = a4 & x13;
+    dsv x15 = x12 ^ x14;
+    dsv x16 = x11 ^ x15;
+    dsv x17 = a3 & x16;
+    dsv x18 = x11 ^ x17;
+    dsv x19 = x12 ^ a2;
+    dsv x20 = a4 & x19;
+    dsv x21 = x12 ^ x20;
+    dsv x23 = a3 & x6;
+    dsv x24 = x21 ^ x23;
+    dsv x25 = x18 ^ x24;
+    dsv x26 = a1 & x25;
+    dsv x27 = x18 ^ x26;
+    dsv x28 = ~x8;
+    dsv x29 = ~x9;
+    dsv x30 = a4 & x7;
+    dsv x31 = x28 ^ x30;
+    dsv x32 = a3 ^ x31;
+    dsv x33 = a4 & x8;
+    dsv x34 = a2 ^ x33;
+    dsv x36 = a3 & x19;
+    dsv x37 = x34 ^ x36;
+    dsv x38 = x32 ^ x37;
+    dsv x39 = a1 & x38;
+    dsv x40 = x32 ^ x39;
+    dsv x41 = x27 ^ x40;
+    dsv x42 = a6 & x41;
+    dsv x43 = x27 ^ x42;
+    dsv x44 = ~x19;
+    dsv x45 = a4 & x29;
+    dsv x46 = x44 ^ x45;
+    dsv x48 = a3 & x28;
+    dsv x49 = x46 ^ x48;
+    dsv x53 = x8 ^ x17;
+    dsv x54 = x49 ^ x53;
+    dsv x55 = a1 & x54;
+    dsv x56 = x49 ^ x55;
+    dsv x57 = ~x49;
+    dsv x58 = a4 ^ a2;
+    dsv x60 = x58 ^ x23;
+    dsv x61 = x57 ^ x60;
+    dsv x62 = a1 & x61;
+    dsv x63 = x57 ^ x62;
+    dsv x64 = x56 ^ x63;
+    dsv x65 = a6 & x64;
+    dsv x66 = x56 ^ x65;
+    dsv x67 = a4 & a5;
+    dsv x68 = x28 ^ x67;
+    dsv x70 = x68 ^ x23;
+    dsv x71 = a4 ^ x29;
+    dsv x72 = a3 & x13;
+    dsv x73 = x71 ^ x72;
+    dsv x74 = x70 ^ x73;
+    dsv x75 = a1 & x74;
+    dsv x76 = x70 ^ x75;
+    dsv x77 = a4 & x12;
+    dsv x78 = x29 ^ x77;
+    dsv x79 = x21 ^ x78;
+    dsv x80 = a3 & x79;
+    dsv x81 = x21 ^ x80;
+    dsv x82 = a4 & x28;
+    dsv x83 = x6 ^ x82;
+    dsv x84 = x83 ^ x68;
+    dsv x85 = a3 & x84;
+    dsv x86 = x83 ^ x85;
+    dsv x87 = x81 ^ x86;
+    dsv x88 = a1 & x87;
+    dsv x89 = x81 ^ x88;
+    dsv x90 = x76 ^ x89;
+    dsv x91 = a6 & x90;
+    dsv x92 = x76 ^ x91;
+    dsv x93 = ~x40;
+    dsv x94 = x78 ^ x15;
+    dsv x95 = a3 & x94;
+    dsv x96 = x78 ^ x95;
+    dsv x97 = a2 ^ x82;
+    dsv x98 = x28 ^ x97;
+    dsv x99 = a3 & x98;
+    dsv x100 = x28 ^ x99;
+    dsv x101 = x96 ^ x100;
+    dsv x102 = a1 & x101;
+    dsv x103 = x96 ^ x102;
+    dsv x104 = x93 ^ x103;
+    dsv x105 = a6 & x104;
+    dsv x106 = x93 ^ x105;
+    *out1 ^= x43;
+    *out2 ^= x66;
+    *out3 ^= x92;
+    *out4 ^= x106;
+}
+
+#endif
@@ -7,7 +7,7 @@
 #include "des.h"
 
 /*
-    PART 2: Encryption using ECB and CBC modes
+    PART 2: Encryption using ECB, CBC and CTR modes
 
     https://en.wikipedia.org/wiki/BMP_file_format
     https://learn.microsoft.com/en-us/windows/win32/gdi/bitmap-structures
@@ -47,39 +47,43 @@ typedef struct {
     uint8_t *data;
 } BMPImage;
 
-BMPImage* readBMPFile(const char *filename) {
-    FILE *file = fopen(filename, "rb");
-    if (!file) {
-        fprintf(stderr, "Error opening file %s\n", filename);
-        return NULL;
-    }
+// size of the pixel data in bytes
+size_t bmpdataSize(const BMPImage *bmp) {
 
-    BMPImage *bmp = (BMPImage*)malloc(sizeof(BMPImage));
-    if (!bmp) {
-        fprintf(stderr, "Memory allocation failed\n");
-        fclose(file);
-        return NULL;
+    size_t dataSize = bmp->infoHeader.imageSize;
+    if (dataSize == 0) {
+        // Some BMP files don't set imageSize correctly, so calculate it
+        int bytesPerPixel = bmp->infoHeader.bitsPerPixel / 8;
+        if (bmp->infoHeader.bitsPerPixel % 8 != 0) bytesPerPixel++;
+
+        // Calculate row size (must be multiple of 4 bytes)
+        int rowSize = (bmp->infoHeader.width * bytesPerPixel + 3) & ~3;
+        dataSize = rowSize * abs(bmp->infoHeader.height);
     }
 
+    return dataSize;
+}
+
+// reads everything but the pixels (bmp->data is left NULL), the file is left at
+// the start of the pixel data
+int readBMPHeaders(FILE *file, BMPImage *bmp) {
+
+    bmp->palette = NULL;
+    bmp->data = NULL;
+
     if (fread(&bmp->header, sizeof(BMPHeader), 1, file) != 1) {
         fprintf(stderr, "Error reading BMP header\n");
-        free(bmp);
-        fclose(file);
-        return NULL;
+        return EXIT_FAILURE;
     }
 
     if (bmp->header.signature[0] != 'B' || bmp->header.signature[1] != 'M') {
         fprintf(stderr, "Not a valid BMP file\n");
-        free(bmp);
-        fclose(file);
-        return NULL;
+        return EXIT_FAILURE;
     }
 
     if (fread(&bmp->infoHeader, sizeof(BMPInfoHeader), 1, file) != 1) {
         fprintf(stderr, "Error reading BMP info header\n");
-        free(bmp);
-        fclose(file);
-        return NULL;
+        return EXIT_FAILURE;
     }
 
     int paletteSize = 0;
@@ -91,37 +95,46 @@ BMPImage* readBMPFile(const char *filename) {
         bmp->palette = (uint8_t*)malloc(paletteSize);
         if (!bmp->palette) {
             fprintf(stderr, "Memory allocation for palette failed\n");
-            free(bmp);
-            fclose(file);
-            return NULL;
+            return EXIT_FAILURE;
         }
 
         // Read the palette
         if (fread(bmp->palette, paletteSize, 1, file) != 1) {
             fprintf(stderr, "Error reading palette\n");
             free(bmp->palette);
-            free(bmp);
-            fclose(file);
-            return NULL;
+            bmp->palette = NULL;
+            return EXIT_FAILURE;
         }
-    } else {
-        bmp->palette = NULL;
     }
 
     // file pointer to start of image data
     fseek(file, bmp->header.dataOffset, SEEK_SET);
 
-    size_t dataSize = bmp->infoHeader.imageSize;
-    if (dataSize == 0) {
-        // Some BMP files don't set imageSize correctly, so calculate it
-        int bytesPerPixel = bmp->infoHeader.bitsPerPixel / 8;
-        if (bmp->infoHeader.bitsPerPixel % 8 != 0) bytesPerPixel++;
+    return EXIT_SUCCESS;
+}
 
-        // Calculate row size (must be multiple of 4 bytes)
-        int rowSize = (bmp->infoHeader.width * bytesPerPixel + 3) & ~3;
-        dataSize = rowSize * abs(bmp->infoHeader.height);
+BMPImage* readBMPFile(const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        fprintf(stderr, "Error opening file %s\n", filename);
+        return NULL;
+    }
+
+    BMPImage *bmp = (BMPImage*)malloc(sizeof(BMPImage));
+    if (!bmp) {
+        fprintf(stderr, "Memory allocation failed\n");
+        fclose(file);
+        return NULL;
+    }
+
+    if (readBMPHeaders(file, bmp) != EXIT_SUCCESS) {
+        free(bmp);
+        fclose(file);
+        return NULL;
     }
 
+    size_t dataSize = bmpdataSize(bmp);
+
     bmp->data = (uint8_t*)malloc(dataSize);
     if (!bmp->data) {
         fprintf(stderr, "Memory allocation for image data failed\n");
@@ -144,24 +157,17 @@ BMPImage* readBMPFile(const char *filename) {
     return bmp;
 }
 
-int writeBMPFile(const char *filename, BMPImage *bmp) {
-    FILE *file = fopen(filename, "wb");
-    if (!file) {
-        fprintf(stderr, "Error opening file %s for writing\n", filename);
-
-        return EXIT_FAILURE;
-    }
+// writes everything but the pixels and leaves the file at the start of the pixel data
+int writeBMPHeaders(FILE *file, const BMPImage *bmp) {
 
     if (fwrite(&bmp->header, sizeof(BMPHeader), 1, file) != 1) {
         fprintf(stderr, "Error writing BMP header\n");
-        fclose(file);
 
         return EXIT_FAILURE;
     }
 
     if (fwrite(&bmp->infoHeader, sizeof(BMPInfoHeader), 1, file) != 1) {
         fprintf(stderr, "Error writing BMP info header\n");
-        fclose(file);
 
         return EXIT_FAILURE;
     }
@@ -170,22 +176,31 @@ int writeBMPFile(const char *filename, BMPImage *bmp) {
         int paletteSize = (1 << bmp->infoHeader.bitsPerPixel) * 4;
         if (fwrite(bmp->palette, paletteSize, 1, file) != 1) {
             fprintf(stderr, "Error writing palette\n");
-            fclose(file);
 
             return EXIT_FAILURE;
         }
     }
 
-    size_t dataSize = bmp->infoHeader.imageSize;
-    if (dataSize == 0) {
-        int bytesPerPixel = bmp->infoHeader.bitsPerPixel / 8;
-        if (bmp->infoHeader.bitsPerPixel % 8 != 0) bytesPerPixel++;
+    fseek(file, bmp->header.dataOffset, SEEK_SET);
 
-        int rowSize = (bmp->infoHeader.width * bytesPerPixel + 3) & ~3;
-        dataSize = rowSize * abs(bmp->infoHeader.height);
+    return EXIT_SUCCESS;
+}
+
+int writeBMPFile(const char *filename, BMPImage *bmp) {
+    FILE *file = fopen(filename, "wb");
+    if (!file) {
+        fprintf(stderr, "Error opening file %s for writing\n", filename);
+
+        return EXIT_FAILURE;
     }
 
-    fseek(file, bmp->header.dataOffset, SEEK_SET);
+    if (writeBMPHeaders(file, bmp) != EXIT_SUCCESS) {
+        fclose(file);
+
+        return EXIT_FAILURE;
+    }
+
+    size_t dataSize = bmpdataSize(bmp);
 
     if (fwrite(bmp->data, dataSize, 1, file) != 1) {
         fprintf(stderr, "Error writing image data\n");
@@ -212,12 +227,8 @@ void ecbEncrypt(const deskeySchedule *ks, const uint8_t *plaintext,
 
     size_t blockNumber = length / DES_BLOCK_SIZE;
 
-    for (size_t i = 0; i < blockNumber; i++) {
-
-        // encrypt each block independently
-        desencryptBlock(ks, plaintext + i * DES_BLOCK_SIZE,
-                         ciphertext + i * DES_BLOCK_SIZE);
-    }
+    // every block is independent, so the whole image goes through the bulk engine
+    desencryptBlocks(ks, plaintext, ciphertext, blockNumber);
 
     size_t remainder = length % DES_BLOCK_SIZE;
 
@@ -228,7 +239,10 @@ void ecbEncrypt(const deskeySchedule *ks, const uint8_t *plaintext,
         // 0s pad
         memset(lastBlock + remainder, 0, DES_BLOCK_SIZE - remainder);
 
-        desencryptBlock(ks, lastBlock, ciphertext + blockNumber * DES_BLOCK_SIZE);
+        // only the bytes that belong to the image are kept, the encrypted block does
+        // not fit in the pixel data
+        desencryptBlock(ks, lastBlock, lastBlock);
+        memcpy(ciphertext + blockNumber * DES_BLOCK_SIZE, lastBlock, remainder);
     }
 }
 
@@ -242,30 +256,13 @@ int encryptBMP_ECB(const char *inputFile, const char *outputFile, const uint8_t
     }
 
     deskeySchedule ks;
-    keySchedule(&ks, key);
-
-    size_t dataSize = bmp->infoHeader.imageSize;
-    if (dataSize == 0) {
-        int bytesPerPixel = bmp->infoHeader.bitsPerPixel / 8;
-        if (bmp->infoHeader.bitsPerPixel % 8 != 0) bytesPerPixel++;
+    keyscheduleCached(&ks, key);
 
-        int rowSize = (bmp->infoHeader.width * bytesPerPixel + 3) & ~3;
-        dataSize = rowSize * abs(bmp->infoHeader.height);
-    }
-
-    uint8_t *encryptedData = (uint8_t*)malloc(dataSize);
-    if (!encryptedData) {
-        fprintf(stderr, "Memory allocation for encrypted data failed\n");
-        freeBMPImage(bmp);
-
-        return EXIT_FAILURE;
-    }
+    size_t dataSize = bmpdataSize(bmp);
 
+    // every block stays where it was, so the pixels are encrypted in place
     printf("ECB Mode: Encrypting %zu bytes of pixel data...\n", dataSize);
-    ecbEncrypt(&ks, bmp->data, encryptedData, dataSize);
-
-    free(bmp->data);
-    bmp->data = encryptedData;
+    ecbEncrypt(&ks, bmp->data, bmp->data, dataSize);
 
     int result = writeBMPFile(outputFile, bmp);
 
@@ -274,49 +271,123 @@ int encryptBMP_ECB(const char *inputFile, const char *outputFile, const uint8_t
     return result;
 }
 
+// pixels are read, encrypted and written this many bytes at a time
+#define STREAM_CHUNK_SIZE (64 * 1024)
+
 int encryptBMP_CBC(const char *inputFile, const char *outputFile, const uint8_t *key, const uint8_t *iv) {
-    // Read the input BMP file
-    BMPImage *bmp = readBMPFile(inputFile);
-    if (!bmp) {
+    // Only the headers are kept in memory, the pixels are streamed through a CTS
+    // context (CBC with ciphertext stealing) one chunk at a time
+    FILE *input = fopen(inputFile, "rb");
+    if (!input) {
+        fprintf(stderr, "Error opening file %s\n", inputFile);
+        return EXIT_FAILURE;
+    }
+
+    BMPImage bmp;
+    if (readBMPHeaders(input, &bmp) != EXIT_SUCCESS) {
         fprintf(stderr, "Failed to read input BMP file\n");
+        fclose(input);
+        return EXIT_FAILURE;
+    }
+
+    FILE *output = fopen(outputFile, "wb");
+    if (!output) {
+        fprintf(stderr, "Error opening file %s for writing\n", outputFile);
+        free(bmp.palette);
+        fclose(input);
         return EXIT_FAILURE;
     }
 
+    int result = writeBMPHeaders(output, &bmp);
+
     // Setup DES key schedule
     deskeySchedule ks;
-    keySchedule(&ks, key);
+    keyscheduleCached(&ks, key);
 
     // Calculate image data size
-    size_t dataSize = bmp->infoHeader.imageSize;
-    if (dataSize == 0) {
-        int bytesPerPixel = bmp->infoHeader.bitsPerPixel / 8;
-        if (bmp->infoHeader.bitsPerPixel % 8 != 0) bytesPerPixel++;
+    size_t dataSize = bmpdataSize(&bmp);
 
-        int rowSize = (bmp->infoHeader.width * bytesPerPixel + 3) & ~3;
-        dataSize = rowSize * abs(bmp->infoHeader.height);
+    // Encrypt the image data using CBC mode, with ciphertext stealing for the last
+    // block so rows that are not a multiple of 8 bytes still fit (when they are it
+    // is the same as plain CBC)
+    printf("CBC Mode: Encrypting %zu bytes of pixel data...\n", dataSize);
+
+    // ctsUpdate can hand out up to two blocks held back from the chunk before
+    uint8_t *chunk = (uint8_t*)malloc(STREAM_CHUNK_SIZE);
+    uint8_t *encrypted = (uint8_t*)malloc(STREAM_CHUNK_SIZE + 2 * DES_BLOCK_SIZE);
+
+    if (!chunk || !encrypted) {
+        fprintf(stderr, "Memory allocation failed\n");
+        result = EXIT_FAILURE;
     }
 
-    // Allocate memory for encrypted data
-    uint8_t *encryptedData = (uint8_t*)malloc(dataSize);
-    if (!encryptedData) {
-        fprintf(stderr, "Memory allocation for encrypted data failed\n");
-        freeBMPImage(bmp);
+    cbcContext ctx;
+    ctsInit(&ctx, &ks, iv, 0);
+
+    size_t remaining = dataSize;
+
+    while (result == EXIT_SUCCESS && remaining > 0) {
+        size_t length = remaining < STREAM_CHUNK_SIZE ? remaining : STREAM_CHUNK_SIZE;
+
+        if (fread(chunk, length, 1, input) != 1) {
+            fprintf(stderr, "Error reading image data\n");
+            result = EXIT_FAILURE;
+            break;
+        }
+
+        size_t written = ctsUpdate(&ctx, chunk, length, encrypted);
+
+        if (written > 0 && fwrite(encrypted, written, 1, output) != 1) {
+            fprintf(stderr, "Error writing image data\n");
+            result = EXIT_FAILURE;
+        }
+
+        remaining -= length;
+    }
+
+    if (result == EXIT_SUCCESS) {
+        size_t written;
+        result = ctsFinal(&ctx, encrypted, &written);
+
+        if (result == EXIT_SUCCESS && written > 0 && fwrite(encrypted, written, 1, output) != 1) {
+            fprintf(stderr, "Error writing image data\n");
+            result = EXIT_FAILURE;
+        }
+    }
+
+    // Clean up
+    free(chunk);
+    free(encrypted);
+    free(bmp.palette);
+    fclose(input);
+
+    if (fclose(output) != 0) {
+        result = EXIT_FAILURE;
+    }
+
+    return result;
+}
+
+int encryptBMP_CTR(const char *inputFile, const char *outputFile, const uint8_t *key, const uint8_t *iv) {
+
+    BMPImage *bmp = readBMPFile(inputFile);
+    if (!bmp) {
+        fprintf(stderr, "Failed to read input BMP file\n");
 
         return EXIT_FAILURE;
     }
 
-    // Encrypt the image data using CBC mode
-    printf("CBC Mode: Encrypting %zu bytes of pixel data...\n", dataSize);
-    cbcEncrypt(&ks, iv, bmp->data, encryptedData, dataSize);
+    deskeySchedule ks;
+    keyscheduleCached(&ks, key);
 
-    // Replace the original data with encrypted data
-    free(bmp->data);
-    bmp->data = encryptedData;
+    size_t dataSize = bmpdataSize(bmp);
+
+    // CTR needs no padding and no second buffer, the pixels are encrypted in place
+    printf("CTR Mode: Encrypting %zu bytes of pixel data...\n", dataSize);
+    ctrEncrypt(&ks, iv, 0, bmp->data, bmp->data, dataSize);
 
-    // Write the encrypted BMP file
     int result = writeBMPFile(outputFile, bmp);
 
-    // Clean up
     freeBMPImage(bmp);
 
     return result;
@@ -332,6 +403,7 @@ int main(int argc, char *argv[]) {
     const char *inputFile = argv[1];
     const char *ecbOutput = "ecb_encrypted.bmp";
     const char *cbcOutput = "cbc_encrypted.bmp";
+    const char *ctrOutput = "ctr_encrypted.bmp";
 
     uint8_t key[8];
     genrandomdesKey(key);
@@ -344,12 +416,12 @@ int main(int argc, char *argv[]) {
     printf("ENCRYPTION PARAMETERS:\n");
     printf("DES Key: ");
     printHex(key, 8);
-    printf("IV (for CBC): ");
+    printf("IV (for CBC and CTR): ");
     printHex(iv, 8);
     printf("\n");
 
     printf("Encrypting using ECB mode...\n");
-    if (encryptBMP_ECB(inputFile, ecbOutput, key)) {
+    if (encryptBMP_ECB(inputFile, ecbOutput, key) == EXIT_SUCCESS) {
         printf("Output saved to: %s\n", ecbOutput);
     } else {
         printf("ECB encryption failed\n");
@@ -358,7 +430,7 @@ int main(int argc, char *argv[]) {
     }
 
     printf("\nEncrypting using CBC mode...\n");
-    if (encryptBMP_CBC(inputFile, cbcOutput, key, iv)) {
+    if (encryptBMP_CBC(inputFile, cbcOutput, key, iv) == EXIT_SUCCESS) {
         printf("Output saved to: %s\n", cbcOutput);
     } else {
         printf("CBC encryption failed\n");
@@ -366,5 +438,14 @@ int main(int argc, char *argv[]) {
         return EXIT_FAILURE;
     }
 
+    printf("\nEncrypting using CTR mode...\n");
+    if (encryptBMP_CTR(inputFile, ctrOutput, key, iv) == EXIT_SUCCESS) {
+        printf("Output saved to: %s\n", ctrOutput);
+    } else {
+        printf("CTR encryption failed\n");
+
+        return EXIT_FAILURE;
+    }
+
     return EXIT_SUCCESS;
 }
\ No newline at end of file
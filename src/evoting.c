@@ -2,6 +2,9 @@
 #include "evoting.h"
 #include "utils.h"
 #include "sha256.h"
+#include "sha256Multi.h"
+#include "rsaBatch.h"
+#include "rsaService.h"
 
 void evoteInit(evote_t *vote) {
     // man memset
@@ -12,6 +15,8 @@ void evoteInit(evote_t *vote) {
     rsainitkeyPair(&vote->keyPair);
 
     vote->mode = MODE_BOTH;
+    vote->cipher = CIPHER_DES;
+    vote->hash = HASH_SHA256;
 }
 
 void evotecleanUp(evote_t *vote) {
@@ -27,6 +32,8 @@ void secureevoteInit(secureEvote_t *secureVote) {
     memset(secureVote->iv, 0, sizeof(secureVote->iv));
 
     secureVote->mode = MODE_BOTH;
+    secureVote->cipher = CIPHER_DES;
+    secureVote->hash = HASH_SHA256;
 }
 
 void secureevotecleanUp(secureEvote_t *secureVote) {
@@ -41,10 +48,177 @@ void secureevotecleanUp(secureEvote_t *secureVote) {
     mpz_clear(secureVote->signature);
 }
 
+// allocate the ciphertext for one vote and describe its encryption as a stream
+// (everything but the key schedule)
+static int prepareEncryption(const evote_t *vote, secureEvote_t *secureVote, desStream *stream) {
+
+    size_t messageLength = strlen(vote->candidateName);
+
+    if (messageLength == 0) {
+        fprintf(stderr, "Candidate name is empty, cannot encrypt\n");
+
+        return EXIT_FAILURE;
+    }
+
+    // always PKCS#7, a whole block of it when the name fills its last block, so
+    // the padding can be told apart from the name
+    size_t encryptedLength = (messageLength / DES_BLOCK_SIZE + 1) * DES_BLOCK_SIZE;
+
+    secureVote->encryptedData = (uint8_t *)malloc(encryptedLength);
+
+    if (!secureVote->encryptedData) {
+        fprintf(stderr, "Memory allocation failed\n");
+
+        return EXIT_FAILURE;
+    }
+
+    secureVote->encryptedLength = encryptedLength;
+
+    // the padded name is encrypted in place
+    pkcs7Padding(secureVote->encryptedData, (const uint8_t *)vote->candidateName,
+                 messageLength, DES_BLOCK_SIZE);
+
+    stream->ks = NULL;
+    stream->iv = vote->iv;
+    stream->plaintext = secureVote->encryptedData;
+    stream->ciphertext = secureVote->encryptedData;
+    stream->length = encryptedLength;
+
+    return EXIT_SUCCESS;
+}
+
+// 3DES ballots are not batched, each one is encrypted on its own
+static void encrypt3(const evote_t *vote, const desStream *stream) {
+
+    des3keySchedule ks;
+    keyscheduleCached3(&ks, vote->des_key);
+
+    des3ctsEncrypt(&ks, stream->iv, stream->plaintext, stream->ciphertext, stream->length);
+}
+
+// what the signature covers: the ciphertext when there is one, else the name
+static const unsigned char *signedData(evotingMode mode, const secureEvote_t *secureVote,
+                                       const char *candidateName, size_t *dataLength) {
+
+    if (mode == MODE_BOTH) {
+        // just sign encrypted data
+        *dataLength = secureVote->encryptedLength;
+
+        return secureVote->encryptedData;
+    }
+
+    // just sign plaintext candidate name
+    *dataLength = strlen(candidateName);
+
+    return (const unsigned char *)candidateName;
+}
+
+// a ballot that could not be signed loses its ciphertext too
+static void signFailed(secureEvote_t *secureVote) {
+
+    fprintf(stderr, "Failed to sign the vote\n");
+
+    if (secureVote->encryptedData) {
+
+        free(secureVote->encryptedData);
+        secureVote->encryptedData = NULL;
+    }
+}
+
+// sign the hash (vote->hash) of the vote's signed data
+static int signVote(const evote_t *vote, secureEvote_t *secureVote, const uint8_t *hash) {
+
+    // just sign the hash and check if its successful
+    if (rsaSign(&vote->keyPair, hash, hashSize(vote->hash), &secureVote->signature) != EXIT_SUCCESS) {
+        signFailed(secureVote);
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// one signed ballot of a batch
+typedef struct {
+    const uint8_t *message;
+    size_t length;
+    hashAlgorithm algorithm;
+    // position of the ballot in the batch
+    size_t index;
+    uint8_t digest[HASH_MAX_SIZE];
+    // 1 once digest is filled in
+    int hashed;
+} signedBallot;
+
+// fill in every digest, the SHA-256 ballots go through the multi-buffer hash
+// together, a ballot that could not be hashed is left with hashed = 0
+static int hashBallots(signedBallot *ballots, size_t count) {
+
+    int result = EXIT_SUCCESS;
+    size_t multiCount = 0;
+
+    for (size_t j = 0; j < count; j++) {
+        ballots[j].hashed = 0;
+
+        if (ballots[j].algorithm == HASH_SHA256) {
+            multiCount++;
+        } else if (hashData(ballots[j].algorithm, ballots[j].message, ballots[j].length,
+                            ballots[j].digest) == EXIT_SUCCESS) {
+            ballots[j].hashed = 1;
+        } else {
+            result = EXIT_FAILURE;
+        }
+    }
+
+    if (multiCount == 0) {
+        return result;
+    }
+
+    const uint8_t **messages = (const uint8_t **)malloc(multiCount * sizeof(uint8_t *));
+    size_t *lengths = (size_t *)malloc(multiCount * sizeof(size_t));
+    uint8_t *digests = (uint8_t *)malloc(multiCount * SHA256_SIZE_BYTES);
+
+    if (!messages || !lengths || !digests) {
+        fprintf(stderr, "Memory allocation failed\n");
+
+        free(messages);
+        free(lengths);
+        free(digests);
+
+        return EXIT_FAILURE;
+    }
+
+    for (size_t j = 0, k = 0; j < count; j++) {
+        if (ballots[j].algorithm == HASH_SHA256) {
+            messages[k] = ballots[j].message;
+            lengths[k] = ballots[j].length;
+            k++;
+        }
+    }
+
+    sha256Multi(messages, lengths, digests, multiCount);
+
+    for (size_t j = 0, k = 0; j < count; j++) {
+        if (ballots[j].algorithm == HASH_SHA256) {
+            memcpy(ballots[j].digest, digests + k * SHA256_SIZE_BYTES, SHA256_SIZE_BYTES);
+            ballots[j].hashed = 1;
+            k++;
+        }
+    }
+
+    free(messages);
+    free(lengths);
+    free(digests);
+
+    return result;
+}
+
 int processVote(const evote_t *vote, secureEvote_t *secureVote) {
 
     // get user chosen mode
     secureVote->mode = vote->mode;
+    secureVote->cipher = vote->cipher;
+    secureVote->hash = vote->hash;
 
     // get IV from the vote for reference
     memcpy(secureVote->iv, vote->iv, sizeof(secureVote->iv));
@@ -53,103 +227,183 @@ int processVote(const evote_t *vote, secureEvote_t *secureVote) {
 
     if (vote->mode == MODE_CONFIDENTIALITY || vote->mode == MODE_BOTH) {
 
-        size_t messageLength = strlen(vote->candidateName);
+        desStream stream;
 
-        deskeySchedule ks;
-        keySchedule(&ks, vote->des_key);
+        if (prepareEncryption(vote, secureVote, &stream) != EXIT_SUCCESS) {
+            return EXIT_FAILURE;
+        }
+
+        if (vote->cipher == CIPHER_3DES) {
+            encrypt3(vote, &stream);
+        } else {
+            deskeySchedule ks;
+            keyscheduleCached(&ks, vote->des_key);
 
-        if (messageLength == 0) {
-            fprintf(stderr, "Candidate name is empty, cannot encrypt\n");
+            ctsEncrypt(&ks, stream.iv, stream.plaintext, stream.ciphertext, stream.length);
+        }
+    }
 
+    if (vote->mode == MODE_AUTHENTICATION || vote->mode == MODE_BOTH) {
+        size_t dataLength;
+        const unsigned char *datatoSign = signedData(vote->mode, secureVote,
+                                                     vote->candidateName, &dataLength);
+
+        // get the hash of the data to sign
+        uint8_t hash[HASH_MAX_SIZE];
+
+        if (hashData(vote->hash, datatoSign, dataLength, hash) != EXIT_SUCCESS) {
             return EXIT_FAILURE;
+        }
 
-        } else if (messageLength <= DES_BLOCK_SIZE) {
-            // pad with PKCS#7 if < 8
-            uint8_t paddedBlock[DES_BLOCK_SIZE];
+        return signVote(vote, secureVote, hash);
+    }
 
-            pkcs7Padding(paddedBlock, (const uint8_t *)vote->candidateName, messageLength, DES_BLOCK_SIZE);
+    return EXIT_SUCCESS;
+}
 
-            secureVote->encryptedData = (uint8_t *)malloc(DES_BLOCK_SIZE);
+int processVotes(const evote_t *votes, secureEvote_t *secureVotes, size_t count) {
 
-            if (!secureVote->encryptedData) {
-                fprintf(stderr, "Memory allocation failed\n");
+    // malloc(0) may be NULL, which is not a failure here
+    if (count == 0) {
+        return EXIT_SUCCESS;
+    }
 
-                return EXIT_FAILURE;
-            }
+    // every ballot has its own key and IV, so all the encryptions are collected
+    // first and run together through the multi stream CBC/CTS
+    deskeySchedule *schedules = (deskeySchedule *)malloc(count * sizeof(deskeySchedule));
+    desStream *streams = (desStream *)calloc(count, sizeof(desStream));
 
-            cbcEncrypt(&ks, vote->iv, paddedBlock, secureVote->encryptedData, DES_BLOCK_SIZE);
+    // and the signed ballots are hashed together too, then signed by the RSA workers
+    signedBallot *ballots = (signedBallot *)malloc(count * sizeof(signedBallot));
+    rsaRequest *requests = (rsaRequest *)malloc(count * sizeof(rsaRequest));
 
-            secureVote->encryptedLength = DES_BLOCK_SIZE;
+    if (!schedules || !streams || !ballots || !requests) {
+        fprintf(stderr, "Memory allocation failed\n");
 
-        } else if (messageLength % DES_BLOCK_SIZE == 0) {
-            // if multiple of 8, use CBC
-            secureVote->encryptedData = (uint8_t *)malloc(messageLength);
-            if (!secureVote->encryptedData) {
-                fprintf(stderr, "Memory allocation failed\n");
-                return EXIT_FAILURE;
-            }
-            cbcEncrypt(&ks, vote->iv, (const uint8_t *)vote->candidateName,
-                    secureVote->encryptedData, messageLength);
-            secureVote->encryptedLength = messageLength;
-        } else {
-            // CTS for != blocksize and > 8
-            secureVote->encryptedData = (uint8_t *)malloc(messageLength);
+        free(schedules);
+        free(streams);
+        free(ballots);
+        free(requests);
+
+        return EXIT_FAILURE;
+    }
+
+    int result = EXIT_SUCCESS;
+    size_t streamCount = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        secureVotes[i].mode = votes[i].mode;
+        secureVotes[i].cipher = votes[i].cipher;
+        secureVotes[i].hash = votes[i].hash;
+        memcpy(secureVotes[i].iv, votes[i].iv, sizeof(secureVotes[i].iv));
 
-            if (!secureVote->encryptedData) {
-                fprintf(stderr, "Memory allocation failed\n");
+        if (votes[i].mode == MODE_CONFIDENTIALITY || votes[i].mode == MODE_BOTH) {
+            desStream *stream = &streams[streamCount];
 
-                return EXIT_FAILURE;
+            if (prepareEncryption(&votes[i], &secureVotes[i], stream) != EXIT_SUCCESS) {
+                result = EXIT_FAILURE;
+                continue;
             }
 
-            ctsEncrypt(&ks, vote->iv, (const uint8_t *)vote->candidateName,
-                    secureVote->encryptedData, messageLength);
+            if (votes[i].cipher == CIPHER_3DES) {
+                encrypt3(&votes[i], stream);
+                continue;
+            }
+
+            keyscheduleCached(&schedules[streamCount], votes[i].des_key);
+            stream->ks = &schedules[streamCount];
 
-            secureVote->encryptedLength = messageLength;
+            streamCount++;
         }
     }
 
-    if (vote->mode == MODE_AUTHENTICATION || vote->mode == MODE_BOTH) {
+    // prepareEncryption pads every stream to at least a block, none can be too
+    // short for CTS
+    ctsencryptStreams(streams, streamCount);
 
+    size_t signCount = 0;
 
-        const unsigned char *datatoSign;
-        size_t dataLength;
+    for (size_t i = 0; i < count; i++) {
+        if (votes[i].mode == MODE_AUTHENTICATION ||
+            (votes[i].mode == MODE_BOTH && secureVotes[i].encryptedData)) {
 
-        if (vote->mode == MODE_BOTH) {
-            // just sign encrypted data
-            datatoSign = secureVote->encryptedData;
-            dataLength = secureVote->encryptedLength;
+            signedBallot *ballot = &ballots[signCount++];
 
-        } else {
-            // just sign plaintext candidate name
-            datatoSign = (const unsigned char *)vote->candidateName;
-            dataLength = strlen(vote->candidateName);
+            ballot->message = signedData(votes[i].mode, &secureVotes[i],
+                                         votes[i].candidateName, &ballot->length);
+            ballot->algorithm = votes[i].hash;
+            ballot->index = i;
         }
+    }
 
-        // get SHA-256 hash of the data to sign
-        uint8_t hash[SHA256_SIZE_BYTES];
+    if (hashBallots(ballots, signCount) != EXIT_SUCCESS) {
+        result = EXIT_FAILURE;
+    }
 
-        sha256_context sha256_ctx;
+    // a ballot without a digest is not signed at all
+    size_t hashedCount = 0;
 
-        sha256_init(&sha256_ctx);
-        sha256_hash(&sha256_ctx, datatoSign, dataLength);
-        sha256_done(&sha256_ctx, hash);
+    for (size_t j = 0; j < signCount; j++) {
+        if (ballots[j].hashed) {
+            ballots[hashedCount++] = ballots[j];
+        } else {
+            signFailed(&secureVotes[ballots[j].index]);
+        }
+    }
 
-        // just sign the hash and check if its successful
-        if (rsaSign(&vote->keyPair, hash, SHA256_SIZE_BYTES, &secureVote->signature) != EXIT_SUCCESS) {
+    signCount = hashedCount;
 
-            fprintf(stderr, "Failed to sign the vote\n");
+    // every ballot has its own key, the signatures are independent and go to the
+    // shared RSA workers, signed one by one here if those could not start
+    rsaService *service = rsaserviceShared();
 
-            if (secureVote->encryptedData) {
+    if (!service) {
+        for (size_t j = 0; j < signCount; j++) {
+            size_t i = ballots[j].index;
 
-                free(secureVote->encryptedData);
-                secureVote->encryptedData = NULL;
+            if (signVote(&votes[i], &secureVotes[i], ballots[j].digest) != EXIT_SUCCESS) {
+                result = EXIT_FAILURE;
             }
+        }
+    } else {
+        rsaCompletion completion;
 
-            return EXIT_FAILURE;
+        rsacompletionInit(&completion);
+
+        for (size_t j = 0; j < signCount; j++) {
+            size_t i = ballots[j].index;
+            rsaRequest *request = &requests[j];
+
+            request->type = RSA_REQUEST_SIGN;
+            request->keyPair = &votes[i].keyPair;
+            request->algorithm = votes[i].hash;
+            request->digest = ballots[j].digest;
+            request->message = NULL;
+            request->length = 0;
+            request->signature = secureVotes[i].signature;
+            request->context = &secureVotes[i];
+
+            rsaserviceSubmit(service, request, &completion);
         }
+
+        for (size_t j = 0; j < signCount; j++) {
+            rsaRequest *request = rsacompletionWait(&completion);
+
+            if (request->result != EXIT_SUCCESS) {
+                signFailed((secureEvote_t *)request->context);
+                result = EXIT_FAILURE;
+            }
+        }
+
+        rsacompletionClear(&completion);
     }
 
-    return EXIT_SUCCESS;
+    free(ballots);
+    free(requests);
+    free(schedules);
+    free(streams);
+
+    return result;
 }
 
 int verifyVote(const secureEvote_t *secureVote, const evote_t *vote_info,
@@ -159,70 +413,181 @@ int verifyVote(const secureEvote_t *secureVote, const evote_t *vote_info,
     int result = 1;
 
     if (secureVote->mode == MODE_AUTHENTICATION || secureVote->mode == MODE_BOTH) {
-        const unsigned char *datatoVerify;
         size_t dataLength;
+        const unsigned char *datatoVerify = signedData(secureVote->mode, secureVote,
+                                                       candidateName, &dataLength);
 
-        if (secureVote->mode == MODE_BOTH) {
+        uint8_t hash[HASH_MAX_SIZE];
 
-            datatoVerify = secureVote->encryptedData;
-            dataLength = secureVote->encryptedLength;
-        } else {
+        if (hashData(secureVote->hash, datatoVerify, dataLength, hash) != EXIT_SUCCESS ||
+            !rsaVerify(&vote_info->keyPair, hash, hashSize(secureVote->hash),
+                       secureVote->signature)) {
+            fprintf(stderr, "Signature verification failed...\n");
 
-            // cast candidateName to unsigned char ptr
-            datatoVerify = (const unsigned char *)candidateName;
+            result = 0;
 
-            dataLength = strlen(candidateName);
+        } else {
+
+            printf("SIGNATURE SUCCESS!\n");
         }
+    }
 
-        uint8_t hash[SHA256_SIZE_BYTES];
-        sha256_context sha256_ctx;
+    if ((secureVote->mode == MODE_CONFIDENTIALITY || secureVote->mode == MODE_BOTH) && result) {
 
-        sha256_init(&sha256_ctx);
-        sha256_hash(&sha256_ctx, datatoVerify, dataLength);
-        sha256_done(&sha256_ctx, hash);
+        size_t length = secureVote->encryptedLength;
 
+        // decrypt straight into the caller's buffer, the null terminator takes the
+        // place of the padding
+        if (length > candidateName_size) {
 
-        if (!rsaVerify(&vote_info->keyPair, hash, SHA256_SIZE_BYTES,
-                       secureVote->signature)) {
-            fprintf(stderr, "Signature verification failed...\n");
+            fprintf(stderr, "Candidate name buffer too small\n");
 
-            result = 0;
+            return 0;
+        }
+
+        if (length < DES_BLOCK_SIZE || length % DES_BLOCK_SIZE != 0) {
+            fprintf(stderr, "Encrypted vote is not a whole number of blocks\n");
+
+            return 0;
+        }
+
+        if (secureVote->cipher == CIPHER_3DES) {
+            des3keySchedule ks;
+            keyscheduleCached3(&ks, vote_info->des_key);
 
+            des3ctsDecrypt(&ks, secureVote->iv, secureVote->encryptedData,
+                           (uint8_t *)candidateName, length);
         } else {
+            deskeySchedule ks;
+            keyscheduleCached(&ks, vote_info->des_key);
 
-            printf("SIGNATURE SUCCESS!\n");
+            ctsDecrypt(&ks, secureVote->iv, secureVote->encryptedData,
+                           (uint8_t *)candidateName, length);
+        }
+
+        // every name was PKCS#7 padded, with 1 to 8 bytes that all hold the count
+        uint8_t pad = (uint8_t)candidateName[length - 1];
+        int padded = pad > 0 && pad <= DES_BLOCK_SIZE && pad <= length;
+
+        for (size_t i = 1; padded && i < pad; i++) {
+            padded = (uint8_t)candidateName[length - 1 - i] == pad;
+        }
+
+        if (!padded) {
+            fprintf(stderr, "Invalid padding in the decrypted vote\n");
+
+            candidateName[0] = '\0';
+
+            return 0;
         }
+
+        length -= pad;
+        candidateName[length] = '\0';
     }
 
-    if ((secureVote->mode == MODE_CONFIDENTIALITY || secureVote->mode == MODE_BOTH) && result) {
+    return result;
+}
 
-        deskeySchedule ks;
-        keySchedule(&ks, vote_info->des_key);
+int verifyVotes(const secureEvote_t *secureVotes, const evote_t *voteInfos, size_t count,
+                int *valid) {
 
-        // alloc mem for decrypted data
-        // +1 for null terminator
-        uint8_t *decrypted = (uint8_t *)malloc(secureVote->encryptedLength + 1);
+    if (count == 0) {
+        return 1;
+    }
 
-        if (!decrypted) {
+    signedBallot *ballots = (signedBallot *)malloc(count * sizeof(signedBallot));
 
-            fprintf(stderr, "Memory allocation failed\n");
+    if (!ballots) {
+        fprintf(stderr, "Memory allocation failed\n");
 
-            return EXIT_FAILURE;
+        return 0;
+    }
+
+    size_t signCount = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        // nothing to check for encryption only ballots
+        valid[i] = 1;
+
+        if (secureVotes[i].mode == MODE_AUTHENTICATION || secureVotes[i].mode == MODE_BOTH) {
+            signedBallot *ballot = &ballots[signCount++];
+
+            ballot->message = signedData(secureVotes[i].mode, &secureVotes[i],
+                                         voteInfos[i].candidateName, &ballot->length);
+            ballot->algorithm = secureVotes[i].hash;
+            ballot->index = i;
         }
+    }
 
-        ctsDecrypt(&ks, secureVote->iv, secureVote->encryptedData,
-                           decrypted, secureVote->encryptedLength);
+    // encryption only ballots, nothing was signed
+    if (signCount == 0) {
+        free(ballots);
 
-        // null terminate the decrypted data, so we dont need to de-pad cbcDecrypt function
-        decrypted[secureVote->encryptedLength] = '\0';
+        return 1;
+    }
+
+    const unsigned char **digests = (const unsigned char **)malloc(signCount * sizeof(unsigned char *));
+    size_t *digestLengths = (size_t *)malloc(signCount * sizeof(size_t));
+    mpz_srcptr *signatures = (mpz_srcptr *)malloc(signCount * sizeof(mpz_srcptr));
+    int *runValid = (int *)malloc(signCount * sizeof(int));
 
-        strncpy(candidateName, (char *)decrypted, candidateName_size - 1);
+    if (!digests || !digestLengths || !signatures || !runValid) {
+        fprintf(stderr, "Memory allocation failed\n");
 
-        candidateName[candidateName_size - 1] = '\0';
+        free(ballots);
+        free(digests);
+        free(digestLengths);
+        free(signatures);
+        free(runValid);
 
-        free(decrypted);
+        return 0;
     }
 
+    // hash every signed ballot at once, one that could not be hashed is invalid
+    int result = hashBallots(ballots, signCount) == EXIT_SUCCESS;
+    size_t hashedCount = 0;
+
+    for (size_t j = 0; j < signCount; j++) {
+        if (ballots[j].hashed) {
+            ballots[hashedCount++] = ballots[j];
+        } else {
+            valid[ballots[j].index] = 0;
+        }
+    }
+
+    signCount = hashedCount;
+
+    // then batch verify every run of ballots signed with the same public key
+    for (size_t start = 0, end; start < signCount; start = end) {
+        const rsakeyPair *keyPair = &voteInfos[ballots[start].index].keyPair;
+
+        for (end = start; end < signCount; end++) {
+            const rsakeyPair *other = &voteInfos[ballots[end].index].keyPair;
+
+            if (mpz_cmp(other->n, keyPair->n) != 0 || mpz_cmp(other->e, keyPair->e) != 0) {
+                break;
+            }
+
+            digests[end - start] = ballots[end].digest;
+            digestLengths[end - start] = hashSize(ballots[end].algorithm);
+            signatures[end - start] = secureVotes[ballots[end].index].signature;
+        }
+
+        if (!rsaverifyBatch(keyPair, digests, digestLengths, signatures, end - start, runValid)) {
+            result = 0;
+        }
+
+        for (size_t j = start; j < end; j++) {
+            valid[ballots[j].index] = runValid[j - start];
+        }
+    }
+
+    free(ballots);
+    free(digests);
+    free(digestLengths);
+    free(signatures);
+    free(runValid);
+
     return result;
 }
 
@@ -248,12 +613,15 @@ void printsecurevoteInfo(const secureEvote_t *secureVote) {
     printHex(secureVote->iv, 8);
 
     if (secureVote->mode == MODE_CONFIDENTIALITY || secureVote->mode == MODE_BOTH) {
+        printf("Cipher: %s\n", secureVote->cipher == CIPHER_3DES ? "3DES (EDE3)" : "DES");
         printf("Encrypted Data (%zu bytes): ", secureVote->encryptedLength);
 
         printHex(secureVote->encryptedData, secureVote->encryptedLength);
     }
 
     if (secureVote->mode == MODE_AUTHENTICATION || secureVote->mode == MODE_BOTH) {
+        printf("Hash: %s\n", hashName(secureVote->hash));
+
         char *signatureString = mpz_get_str(NULL, 16, secureVote->signature);
 
         printf("Digital signature (hex): %s\n", signatureString);
@@ -269,8 +637,13 @@ void printvoteInfo(const evote_t *vote) {
 
     printf("Candidate name: %s\n", vote->candidateName);
 
-    printf("DES key: ");
-    printHex(vote->des_key, 8);
+    if (vote->cipher == CIPHER_3DES) {
+        printf("3DES key: ");
+        printHex(vote->des_key, DES3_KEY_SIZE);
+    } else {
+        printf("DES key: ");
+        printHex(vote->des_key, 8);
+    }
 
     printf("IV: ");
     printHex(vote->iv, 8);
@@ -291,6 +664,10 @@ void printvoteInfo(const evote_t *vote) {
             printf("Something went wrong, unknown :(\n");
     }
 
+    if (vote->mode == MODE_AUTHENTICATION || vote->mode == MODE_BOTH) {
+        printf("Hash: %s\n", hashName(vote->hash));
+    }
+
     printf("RSA key info:\n");
 
     printrsakeyInfo(&vote->keyPair);
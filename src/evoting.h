@@ -9,6 +9,7 @@
 #include "des.h"
 #include "rsa.h"
 #include "rsaKeygen.h"
+#include "hash.h"
 
 typedef enum {
     // DES (symmetric encryption) w/ CBC and CTS modes
@@ -18,12 +19,23 @@ typedef enum {
     MODE_BOTH = 3
 } evotingMode;
 
+typedef enum {
+    // single DES, 8 byte key
+    CIPHER_DES = 1,
+    // 3DES EDE3, 24 byte key
+    CIPHER_3DES = 2
+} evotingCipher;
+
 typedef struct {
     char candidateName[256];
-    uint8_t des_key[8];
+    // DES uses the first 8 bytes, 3DES all 24
+    uint8_t des_key[DES3_KEY_SIZE];
     uint8_t iv[8];
     rsakeyPair keyPair;
     evotingMode mode;
+    evotingCipher cipher;
+    // hash under the signature, per election
+    hashAlgorithm hash;
 } evote_t;
 
 typedef struct {
@@ -32,6 +44,8 @@ typedef struct {
     mpz_t signature;
     uint8_t iv[8];
     evotingMode mode;
+    evotingCipher cipher;
+    hashAlgorithm hash;
 } secureEvote_t;
 
 void evoteInit(evote_t *vote);
@@ -39,8 +53,18 @@ void evotecleanUp(evote_t *vote);
 void secureevoteInit(secureEvote_t *secureVote);
 void secureevotecleanUp(secureEvote_t *secureVote);
 int processVote(const evote_t *vote, secureEvote_t *secureVote);
+// same as processVote over a whole batch, the DES part runs all ballots in lockstep
+int processVotes(const evote_t *votes, secureEvote_t *secureVotes, size_t count);
 int verifyVote(const secureEvote_t *secureVote, const evote_t *vote_info,
                 char *candidateName, size_t candidateName_size);
+// check the signatures of a whole batch, SHA-256 ballots are hashed together
+// through the multi-buffer SHA-256 and consecutive ballots under the same public
+// key are verified together (rsaBatch.h), valid[i] is set to 0 or 1 (ballots
+// without a signature are valid) and the result is 1 when every ballot is.
+// Authentication only ballots are checked against voteInfos[i].candidateName,
+// nothing is decrypted
+int verifyVotes(const secureEvote_t *secureVotes, const evote_t *voteInfos, size_t count,
+                int *valid);
 void printsecurevoteInfo(const secureEvote_t *secureVote);
 void printvoteInfo(const evote_t *vote);
 
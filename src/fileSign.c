@@ -0,0 +1,406 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "fileSign.h"
+#include "sha256Tree.h"
+
+// https://man7.org/linux/man-pages/man2/mmap.2.html
+// https://man7.org/linux/man-pages/man2/madvise.2.html
+
+// a mapping is hashed one window at a time, the next window is announced with
+// MADV_WILLNEED and the pages behind are dropped, so a multi GB file never has to
+// be resident at once
+#define MAP_WINDOW_SIZE (64 * 1024 * 1024)
+
+// each of the two buffers of the read fallback
+#define READ_BUFFER_SIZE (8 * 1024 * 1024)
+
+typedef void (*fileUpdate)(void *ctx, const uint8_t *data, size_t length);
+
+static int feedMapped(int fd, size_t size, fileUpdate update, void *ctx) {
+
+    uint8_t *map = (uint8_t *)mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+
+    if (map == MAP_FAILED) {
+        return EXIT_FAILURE;
+    }
+
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    for (size_t done = 0; done < size; done += MAP_WINDOW_SIZE) {
+        size_t length = size - done < MAP_WINDOW_SIZE ? size - done : MAP_WINDOW_SIZE;
+
+        if (done + length < size) {
+            size_t next = size - done - length < MAP_WINDOW_SIZE ? size - done - length
+                                                                 : MAP_WINDOW_SIZE;
+
+            madvise(map + done + length, next, MADV_WILLNEED);
+        }
+
+        update(ctx, map + done, length);
+
+        // the file is not changed, the pages stay in the page cache and are only
+        // dropped from this mapping (done is a multiple of the page size)
+        madvise(map + done, length, MADV_DONTNEED);
+    }
+
+    munmap(map, size);
+
+    return EXIT_SUCCESS;
+}
+
+typedef struct {
+    int fd;
+    uint8_t *buffers[2];
+    size_t filled[2];
+    // 1 while a buffer holds data that was not hashed yet
+    int full[2];
+    int error;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} readAhead;
+
+// fill the buffers in turn until a read comes back short
+static void *readerMain(void *arg) {
+
+    readAhead *ra = (readAhead *)arg;
+
+    for (int b = 0;; b ^= 1) {
+        pthread_mutex_lock(&ra->lock);
+
+        while (ra->full[b]) {
+            pthread_cond_wait(&ra->changed, &ra->lock);
+        }
+
+        pthread_mutex_unlock(&ra->lock);
+
+        size_t filled = 0;
+        int error = 0;
+
+        while (filled < READ_BUFFER_SIZE) {
+            ssize_t n = read(ra->fd, ra->buffers[b] + filled, READ_BUFFER_SIZE - filled);
+
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (n <= 0) {
+                error = n < 0;
+                break;
+            }
+
+            filled += (size_t)n;
+        }
+
+        pthread_mutex_lock(&ra->lock);
+
+        ra->filled[b] = filled;
+        ra->full[b] = 1;
+        ra->error = error;
+
+        pthread_cond_broadcast(&ra->changed);
+        pthread_mutex_unlock(&ra->lock);
+
+        // short read, end of the file (or an error)
+        if (filled < READ_BUFFER_SIZE) {
+            return NULL;
+        }
+    }
+}
+
+static int feedReads(int fd, fileUpdate update, void *ctx) {
+
+    readAhead ra;
+
+    ra.fd = fd;
+    ra.buffers[0] = (uint8_t *)malloc(READ_BUFFER_SIZE);
+    ra.buffers[1] = (uint8_t *)malloc(READ_BUFFER_SIZE);
+    ra.filled[0] = ra.filled[1] = 0;
+    ra.full[0] = ra.full[1] = 0;
+    ra.error = 0;
+
+    if (!ra.buffers[0] || !ra.buffers[1]) {
+        fprintf(stderr, "Memory allocation failed\n");
+
+        free(ra.buffers[0]);
+        free(ra.buffers[1]);
+
+        return EXIT_FAILURE;
+    }
+
+    pthread_mutex_init(&ra.lock, NULL);
+    pthread_cond_init(&ra.changed, NULL);
+
+    pthread_t reader;
+
+    if (pthread_create(&reader, NULL, readerMain, &ra) != 0) {
+        fprintf(stderr, "Failed to start reader thread\n");
+
+        pthread_mutex_destroy(&ra.lock);
+        pthread_cond_destroy(&ra.changed);
+        free(ra.buffers[0]);
+        free(ra.buffers[1]);
+
+        return EXIT_FAILURE;
+    }
+
+    int error = 0;
+
+    for (int b = 0;; b ^= 1) {
+        pthread_mutex_lock(&ra.lock);
+
+        while (!ra.full[b]) {
+            pthread_cond_wait(&ra.changed, &ra.lock);
+        }
+
+        size_t filled = ra.filled[b];
+        error = ra.error;
+
+        pthread_mutex_unlock(&ra.lock);
+
+        if (filled == 0 || error) {
+            break;
+        }
+
+        // the reader is already filling the other buffer
+        update(ctx, ra.buffers[b], filled);
+
+        pthread_mutex_lock(&ra.lock);
+
+        ra.full[b] = 0;
+
+        pthread_cond_broadcast(&ra.changed);
+        pthread_mutex_unlock(&ra.lock);
+
+        if (filled < READ_BUFFER_SIZE) {
+            break;
+        }
+    }
+
+    pthread_join(reader, NULL);
+
+    pthread_mutex_destroy(&ra.lock);
+    pthread_cond_destroy(&ra.changed);
+    free(ra.buffers[0]);
+    free(ra.buffers[1]);
+
+    return error ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// run every byte of the file through update, mapped when possible
+static int feedFile(const char *path, fileUpdate update, void *ctx) {
+
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+
+        return EXIT_FAILURE;
+    }
+
+    struct stat st;
+    int regular = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+    int result;
+
+    if (regular && st.st_size == 0) {
+        // nothing to map
+        result = EXIT_SUCCESS;
+    } else if (regular && feedMapped(fd, (size_t)st.st_size, update, ctx) == EXIT_SUCCESS) {
+        result = EXIT_SUCCESS;
+    } else {
+        result = feedReads(fd, update, ctx);
+    }
+
+    if (result != EXIT_SUCCESS) {
+        fprintf(stderr, "Failed to read %s\n", path);
+    }
+
+    close(fd);
+
+    return result;
+}
+
+static void hashUpdater(void *ctx, const uint8_t *data, size_t length) {
+    hashUpdate((hashContext *)ctx, data, length);
+}
+
+// leaf digests of the tree hash so far, and the leaf that is not full yet
+typedef struct {
+    uint8_t *digests;
+    size_t leaves;
+    size_t capacity;
+    sha256_context partial;
+    size_t partialLength;
+    int failed;
+} treeState;
+
+static void treeAppend(treeState *tree, size_t leaves) {
+
+    if (tree->leaves + leaves <= tree->capacity) {
+        return;
+    }
+
+    size_t capacity = tree->capacity ? tree->capacity : 64;
+
+    while (capacity < tree->leaves + leaves) {
+        capacity *= 2;
+    }
+
+    uint8_t *digests = (uint8_t *)realloc(tree->digests, capacity * SHA256_SIZE_BYTES);
+
+    if (!digests) {
+        tree->failed = 1;
+
+        return;
+    }
+
+    tree->digests = digests;
+    tree->capacity = capacity;
+}
+
+static void treeUpdater(void *ctx, const uint8_t *data, size_t length) {
+
+    treeState *tree = (treeState *)ctx;
+
+    if (tree->failed) {
+        return;
+    }
+
+    // finish the leaf the last chunk stopped in
+    if (tree->partialLength > 0) {
+        size_t take = SHA256_TREE_LEAF_SIZE - tree->partialLength;
+
+        if (take > length) {
+            take = length;
+        }
+
+        sha256_hash(&tree->partial, data, take);
+        tree->partialLength += take;
+        data += take;
+        length -= take;
+
+        if (tree->partialLength < SHA256_TREE_LEAF_SIZE) {
+            return;
+        }
+
+        treeAppend(tree, 1);
+
+        if (tree->failed) {
+            return;
+        }
+
+        sha256_done(&tree->partial, tree->digests + tree->leaves * SHA256_SIZE_BYTES);
+        tree->leaves++;
+        tree->partialLength = 0;
+    }
+
+    // the map windows and read buffers are whole leaves, this is the usual case
+    size_t whole = length / SHA256_TREE_LEAF_SIZE;
+
+    if (whole > 0) {
+        treeAppend(tree, whole);
+
+        if (tree->failed) {
+            return;
+        }
+
+        sha256treeLeaves(data, whole * SHA256_TREE_LEAF_SIZE, SHA256_TREE_LEAF_SIZE,
+                         tree->digests + tree->leaves * SHA256_SIZE_BYTES);
+        tree->leaves += whole;
+        data += whole * SHA256_TREE_LEAF_SIZE;
+        length -= whole * SHA256_TREE_LEAF_SIZE;
+    }
+
+    if (length > 0) {
+        const uint8_t tag = SHA256_TREE_LEAF;
+
+        sha256_init(&tree->partial);
+        sha256_hash(&tree->partial, &tag, 1);
+        sha256_hash(&tree->partial, data, length);
+        tree->partialLength = length;
+    }
+}
+
+static int fileTreeDigest(const char *path, uint8_t *digest) {
+
+    treeState tree;
+    int result = EXIT_FAILURE;
+
+    memset(&tree, 0, sizeof(tree));
+
+    if (feedFile(path, treeUpdater, &tree) == EXIT_SUCCESS) {
+        // the short last leaf, or the one empty leaf of an empty file
+        if (tree.partialLength > 0 || tree.leaves == 0) {
+            treeAppend(&tree, 1);
+
+            if (!tree.failed) {
+                if (tree.partialLength > 0) {
+                    sha256_done(&tree.partial, tree.digests + tree.leaves * SHA256_SIZE_BYTES);
+                } else {
+                    sha256treeLeaf(NULL, 0, tree.digests);
+                }
+
+                tree.leaves++;
+            }
+        }
+
+        if (tree.failed) {
+            fprintf(stderr, "Memory allocation failed\n");
+        } else {
+            sha256treeRoot(tree.digests, tree.leaves, digest);
+            result = EXIT_SUCCESS;
+        }
+    }
+
+    free(tree.digests);
+
+    return result;
+}
+
+int fileDigest(const char *path, hashAlgorithm algorithm, uint8_t *digest) {
+
+    if (algorithm == HASH_SHA256_TREE) {
+        return fileTreeDigest(path, digest);
+    }
+
+    hashContext ctx;
+
+    if (hashInit(&ctx, algorithm) != EXIT_SUCCESS ||
+        feedFile(path, hashUpdater, &ctx) != EXIT_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+
+    hashFinal(&ctx, digest);
+
+    return EXIT_SUCCESS;
+}
+
+int fileSign(const rsakeyPair *keyPair, const char *path, hashAlgorithm algorithm,
+             mpz_t *signature) {
+
+    uint8_t digest[HASH_MAX_SIZE];
+
+    if (fileDigest(path, algorithm, digest) != EXIT_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+
+    return rsaSign(keyPair, digest, hashSize(algorithm), signature);
+}
+
+int fileVerify(const rsakeyPair *keyPair, const char *path, hashAlgorithm algorithm,
+               const mpz_t signature) {
+
+    uint8_t digest[HASH_MAX_SIZE];
+
+    if (fileDigest(path, algorithm, digest) != EXIT_SUCCESS) {
+        return 0;
+    }
+
+    return rsaVerify(keyPair, digest, hashSize(algorithm), signature);
+}
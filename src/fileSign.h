@@ -0,0 +1,29 @@
+#ifndef FILE_SIGN_H
+#define FILE_SIGN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <gmp.h>
+#include "rsa.h"
+#include "hash.h"
+
+/*
+    Digest and RSA signature of whole files (exported ballot archives, ...)
+
+    Regular files are mmap'ed and hashed straight from the page cache with
+    MADV_SEQUENTIAL, so the kernel reads ahead and nothing is copied through stdio.
+    Anything that cannot be mapped (pipes, some special files) is read with two
+    large buffers, a reader thread fills one while the other is hashed.
+*/
+
+// hash of the file's contents, hashSize(algorithm) bytes
+int fileDigest(const char *path, hashAlgorithm algorithm, uint8_t *digest);
+
+// signature of the file's hash, like rsaSign on the hash of an in memory message
+int fileSign(const rsakeyPair *keyPair, const char *path, hashAlgorithm algorithm,
+             mpz_t *signature);
+// 1 if signature matches the file, 0 if not (or the file cannot be read)
+int fileVerify(const rsakeyPair *keyPair, const char *path, hashAlgorithm algorithm,
+               const mpz_t signature);
+
+#endif
@@ -0,0 +1,258 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <gmp.h>
+#include "fileSign.h"
+#include "rsa.h"
+#include "rsaKeygen.h"
+#include "utils.h"
+
+/*
+    Sign and verify files with RSA over their hash (SHA-256 unless -H says otherwise)
+
+    Key files hold one hex number per line: n, e and, for a private key, d, p, q.
+    keygen writes both <key> (private) and <key>.pub (n and e only).
+    Signatures are written to <file>.sig unless another path is given, as the hash
+    id and the hex signature, so verify knows which hash to use.
+*/
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr, "  %s keygen <key> [bits]\n", program);
+    fprintf(stderr, "  %s [-H hash] digest <file>\n", program);
+    fprintf(stderr, "  %s [-H hash] sign <key> <file> [signature]\n", program);
+    fprintf(stderr, "  %s verify <key> <file> [signature]\n", program);
+    fprintf(stderr, "hash: sha256 (default), sha512, sha512-256, blake3, sha256-tree\n");
+}
+
+// a signature file is "<hash id> <hex signature>", a bare hex number is SHA-256
+static int readSignature(const char *path, hashAlgorithm *algorithm, mpz_t signature) {
+
+    FILE *file = fopen(path, "r");
+    char first[1024];
+
+    if (!file || fscanf(file, "%1023s", first) != 1) {
+        if (file) {
+            fclose(file);
+        }
+
+        return EXIT_FAILURE;
+    }
+
+    *algorithm = hashFromId(first);
+
+    int ok = *algorithm ? mpz_inp_str(signature, file, 16) != 0
+                        : mpz_set_str(signature, first, 16) == 0;
+
+    if (!*algorithm) {
+        *algorithm = HASH_SHA256;
+    }
+
+    fclose(file);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int writeKey(const char *path, const rsakeyPair *keyPair, int private) {
+
+    FILE *file = NULL;
+
+    if (private) {
+        // owner only from the start, and fchmod for a key file that was already there
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+
+        if (fd >= 0 && (fchmod(fd, 0600) != 0 || !(file = fdopen(fd, "w")))) {
+            close(fd);
+        }
+    } else {
+        file = fopen(path, "w");
+    }
+
+    if (!file) {
+        fprintf(stderr, "Cannot write %s\n", path);
+
+        return EXIT_FAILURE;
+    }
+
+    // https://gmplib.org/manual/I_002fO-of-Integers
+    mpz_out_str(file, 16, keyPair->n);
+    fputc('\n', file);
+    mpz_out_str(file, 16, keyPair->e);
+    fputc('\n', file);
+
+    if (private) {
+        mpz_out_str(file, 16, keyPair->d);
+        fputc('\n', file);
+        mpz_out_str(file, 16, keyPair->p);
+        fputc('\n', file);
+        mpz_out_str(file, 16, keyPair->q);
+        fputc('\n', file);
+    }
+
+    fclose(file);
+
+    return EXIT_SUCCESS;
+}
+
+// reads n and e, and whatever private part is there, returns how many numbers
+static int readKey(const char *path, rsakeyPair *keyPair) {
+
+    FILE *file = fopen(path, "r");
+
+    if (!file) {
+        fprintf(stderr, "Cannot read %s\n", path);
+
+        return 0;
+    }
+
+    mpz_t *parts[] = { &keyPair->n, &keyPair->e, &keyPair->d, &keyPair->p, &keyPair->q };
+    int count = 0;
+
+    while (count < 5 && mpz_inp_str(*parts[count], file, 16) != 0) {
+        count++;
+    }
+
+    fclose(file);
+
+    if (count < 2) {
+        fprintf(stderr, "%s is not a key file\n", path);
+    }
+
+    // the CRT values and contexts are derived, they are not stored in the file
+    if (count == 5) {
+        rsacomputeCrt(keyPair);
+    } else {
+        rsapreparePublic(keyPair);
+    }
+
+    return count;
+}
+
+static void signaturePath(char *buffer, size_t size, const char *file, int argc, char **argv) {
+
+    if (argc > 4) {
+        snprintf(buffer, size, "%s", argv[4]);
+    } else {
+        snprintf(buffer, size, "%s.sig", file);
+    }
+}
+
+int main(int argc, char **argv) {
+
+    const char *program = argv[0];
+    hashAlgorithm algorithm = HASH_SHA256;
+
+    if (argc > 2 && strcmp(argv[1], "-H") == 0) {
+        algorithm = hashFromId(argv[2]);
+
+        if (!algorithm) {
+            fprintf(stderr, "Unknown hash %s\n", argv[2]);
+            usage(program);
+
+            return EXIT_FAILURE;
+        }
+
+        // the rest reads as if there was no option
+        argv += 2;
+        argc -= 2;
+    }
+
+    if (argc < 3) {
+        usage(program);
+
+        return EXIT_FAILURE;
+    }
+
+    const char *command = argv[1];
+
+    if (strcmp(command, "digest") == 0) {
+        uint8_t digest[HASH_MAX_SIZE];
+
+        if (fileDigest(argv[2], algorithm, digest) != EXIT_SUCCESS) {
+            return EXIT_FAILURE;
+        }
+
+        printHex(digest, hashSize(algorithm));
+
+        return EXIT_SUCCESS;
+    }
+
+    rsakeyPair keyPair;
+    rsainitkeyPair(&keyPair);
+
+    int result = EXIT_FAILURE;
+
+    if (strcmp(command, "keygen") == 0) {
+        unsigned int bits = argc > 3 ? (unsigned int)strtoul(argv[3], NULL, 10) : 2048;
+        char publicPath[4096];
+
+        snprintf(publicPath, sizeof(publicPath), "%s.pub", argv[2]);
+
+        if (rsagenKey(&keyPair, bits) == EXIT_SUCCESS &&
+            writeKey(argv[2], &keyPair, 1) == EXIT_SUCCESS &&
+            writeKey(publicPath, &keyPair, 0) == EXIT_SUCCESS) {
+
+            printf("Wrote %s and %s\n", argv[2], publicPath);
+            result = EXIT_SUCCESS;
+        }
+
+    } else if (strcmp(command, "sign") == 0 && argc > 3) {
+        char sigPath[4096];
+        signaturePath(sigPath, sizeof(sigPath), argv[3], argc, argv);
+
+        if (readKey(argv[2], &keyPair) < 3) {
+            fprintf(stderr, "Signing needs a private key\n");
+        } else {
+            mpz_t signature;
+            mpz_init(signature);
+
+            if (fileSign(&keyPair, argv[3], algorithm, &signature) == EXIT_SUCCESS) {
+                FILE *file = fopen(sigPath, "w");
+
+                if (file) {
+                    fprintf(file, "%s ", hashId(algorithm));
+                    mpz_out_str(file, 16, signature);
+                    fputc('\n', file);
+                    fclose(file);
+
+                    printf("Wrote %s\n", sigPath);
+                    result = EXIT_SUCCESS;
+                } else {
+                    fprintf(stderr, "Cannot write %s\n", sigPath);
+                }
+            }
+
+            mpz_clear(signature);
+        }
+
+    } else if (strcmp(command, "verify") == 0 && argc > 3) {
+        char sigPath[4096];
+        signaturePath(sigPath, sizeof(sigPath), argv[3], argc, argv);
+
+        mpz_t signature;
+        mpz_init(signature);
+
+        if (readKey(argv[2], &keyPair) < 2) {
+            // already reported
+        } else if (readSignature(sigPath, &algorithm, signature) != EXIT_SUCCESS) {
+            fprintf(stderr, "Cannot read signature %s\n", sigPath);
+        } else if (fileVerify(&keyPair, argv[3], algorithm, signature)) {
+            printf("SIGNATURE SUCCESS! (%s)\n", hashName(algorithm));
+            result = EXIT_SUCCESS;
+        } else {
+            fprintf(stderr, "Signature verification failed...\n");
+        }
+
+        mpz_clear(signature);
+
+    } else {
+        usage(program);
+    }
+
+    rsaclearkeyPair(&keyPair);
+
+    return result;
+}
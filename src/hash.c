@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+#include "hash.h"
+#include "sha256Tree.h"
+
+size_t hashSize(hashAlgorithm algorithm) {
+
+    switch (algorithm) {
+        case HASH_SHA256:
+        case HASH_SHA256_TREE:
+            return SHA256_SIZE_BYTES;
+        case HASH_SHA512:
+            return SHA512_SIZE_BYTES;
+        case HASH_SHA512_256:
+            return SHA512_256_SIZE_BYTES;
+        case HASH_BLAKE3:
+            return BLAKE3_SIZE_BYTES;
+        default:
+            return 0;
+    }
+}
+
+const char *hashName(hashAlgorithm algorithm) {
+
+    switch (algorithm) {
+        case HASH_SHA256:
+            return "SHA-256";
+        case HASH_SHA512:
+            return "SHA-512";
+        case HASH_SHA512_256:
+            return "SHA-512/256";
+        case HASH_BLAKE3:
+            return "BLAKE3";
+        case HASH_SHA256_TREE:
+            return "SHA-256 tree";
+        default:
+            return "unknown";
+    }
+}
+
+const char *hashId(hashAlgorithm algorithm) {
+
+    switch (algorithm) {
+        case HASH_SHA256:
+            return "sha256";
+        case HASH_SHA512:
+            return "sha512";
+        case HASH_SHA512_256:
+            return "sha512-256";
+        case HASH_BLAKE3:
+            return "blake3";
+        case HASH_SHA256_TREE:
+            return "sha256-tree";
+        default:
+            return "unknown";
+    }
+}
+
+hashAlgorithm hashFromId(const char *id) {
+
+    for (int algorithm = HASH_SHA256; algorithm <= HASH_SHA256_TREE; algorithm++) {
+        if (strcasecmp(id, hashId((hashAlgorithm)algorithm)) == 0) {
+            return (hashAlgorithm)algorithm;
+        }
+    }
+
+    return (hashAlgorithm)0;
+}
+
+int hashInit(hashContext *ctx, hashAlgorithm algorithm) {
+
+    ctx->algorithm = algorithm;
+
+    switch (algorithm) {
+        case HASH_SHA256:
+            sha256_init(&ctx->ctx.sha256);
+            break;
+        case HASH_SHA512:
+            sha512_init(&ctx->ctx.sha512);
+            break;
+        case HASH_SHA512_256:
+            sha512_256_init(&ctx->ctx.sha512);
+            break;
+        case HASH_BLAKE3:
+            blake3Init(&ctx->ctx.blake3);
+            break;
+        case HASH_SHA256_TREE:
+            fprintf(stderr, "The SHA-256 tree hash cannot be streamed\n");
+
+            return EXIT_FAILURE;
+        default:
+            fprintf(stderr, "Unknown hash algorithm %d\n", (int)algorithm);
+
+            return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+void hashUpdate(hashContext *ctx, const uint8_t *data, size_t length) {
+
+    if (ctx->algorithm == HASH_SHA256) {
+        sha256_hash(&ctx->ctx.sha256, data, length);
+    } else if (ctx->algorithm == HASH_BLAKE3) {
+        blake3Update(&ctx->ctx.blake3, data, length);
+    } else {
+        sha512_hash(&ctx->ctx.sha512, data, length);
+    }
+}
+
+void hashFinal(hashContext *ctx, uint8_t *digest) {
+
+    if (ctx->algorithm == HASH_SHA256) {
+        sha256_done(&ctx->ctx.sha256, digest);
+    } else if (ctx->algorithm == HASH_BLAKE3) {
+        blake3Final(&ctx->ctx.blake3, digest);
+    } else {
+        sha512_done(&ctx->ctx.sha512, digest);
+    }
+}
+
+int hashData(hashAlgorithm algorithm, const uint8_t *data, size_t length, uint8_t *digest) {
+
+    if (algorithm == HASH_SHA256) {
+        sha256_short(data, length, digest);
+
+        return EXIT_SUCCESS;
+    }
+
+    if (algorithm == HASH_BLAKE3) {
+        blake3(data, length, digest);
+
+        return EXIT_SUCCESS;
+    }
+
+    if (algorithm == HASH_SHA256_TREE) {
+        return sha256Tree(data, length, 0, digest);
+    }
+
+    hashContext ctx;
+
+    if (hashInit(&ctx, algorithm) != EXIT_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+
+    hashUpdate(&ctx, data, length);
+    hashFinal(&ctx, digest);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,59 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sha256.h"
+#include "sha512.h"
+#include "blake3.h"
+
+/*
+    One entry point for the hashes an election can be configured with, so the vote
+    and file signing code does not care which one it is
+
+    BLAKE3 is not a SHA-2, it is meant for internal integrity checks (ballot logs,
+    fingerprints, archives) where nothing outside has to recompute the hash.
+
+    The SHA-256 tree hash (sha256Tree.h) is for large files, its leaves are hashed
+    in parallel. It has no streaming form, only hashData and fileDigest take it.
+*/
+
+typedef enum {
+    HASH_SHA256 = 1,
+    HASH_SHA512 = 2,
+    HASH_SHA512_256 = 3,
+    HASH_BLAKE3 = 4,
+    HASH_SHA256_TREE = 5
+} hashAlgorithm;
+
+// the longest digest of any of them
+#define HASH_MAX_SIZE 64
+
+typedef struct {
+    hashAlgorithm algorithm;
+    union {
+        sha256_context sha256;
+        sha512_context sha512;
+        blake3Context blake3;
+    } ctx;
+} hashContext;
+
+// digest size in bytes, 0 for an unknown algorithm
+size_t hashSize(hashAlgorithm algorithm);
+const char *hashName(hashAlgorithm algorithm);
+// short name for files and command lines ("sha256", "sha512", "sha512-256", "blake3",
+// "sha256-tree")
+const char *hashId(hashAlgorithm algorithm);
+// 0 if id is not one of them
+hashAlgorithm hashFromId(const char *id);
+
+// EXIT_FAILURE for an unknown algorithm and for the tree hash
+int hashInit(hashContext *ctx, hashAlgorithm algorithm);
+void hashUpdate(hashContext *ctx, const uint8_t *data, size_t length);
+// writes hashSize(algorithm) bytes
+void hashFinal(hashContext *ctx, uint8_t *digest);
+
+// one-shot, short SHA-256 messages take sha256_short
+int hashData(hashAlgorithm algorithm, const uint8_t *data, size_t length, uint8_t *digest);
+
+#endif
@@ -0,0 +1,200 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "hmac.h"
+#include "sha256Multi.h"
+
+void hmacInit(hmacKey *hk, const uint8_t *key, size_t keyLength) {
+
+    uint8_t block[64] = {0};
+    uint8_t pad[64];
+
+    // keys longer than a block are hashed first, shorter ones zero filled
+    if (keyLength > sizeof(block)) {
+        sha256(key, keyLength, block);
+    } else if (keyLength > 0) {
+        memcpy(block, key, keyLength);
+    }
+
+    for (size_t i = 0; i < sizeof(block); i++) {
+        pad[i] = block[i] ^ 0x36;
+    }
+
+    sha256_prefix(&hk->inner, pad, sizeof(pad));
+
+    for (size_t i = 0; i < sizeof(block); i++) {
+        pad[i] = block[i] ^ 0x5c;
+    }
+
+    sha256_prefix(&hk->outer, pad, sizeof(pad));
+
+    memset(block, 0, sizeof(block));
+    memset(pad, 0, sizeof(pad));
+}
+
+void hmacSha256(const hmacKey *hk, const uint8_t *message, size_t length, uint8_t *mac) {
+
+    uint8_t inner[SHA256_SIZE_BYTES];
+
+    sha256_prefixed(&hk->inner, message, length, inner);
+    sha256_prefixed(&hk->outer, inner, sizeof(inner), mac);
+}
+
+int hmacVerify(const hmacKey *hk, const uint8_t *message, size_t length, const uint8_t *mac) {
+
+    uint8_t expected[HMAC_SIZE];
+    uint8_t diff = 0;
+
+    hmacSha256(hk, message, length, expected);
+
+    // no early exit, a timing difference would tell how many bytes were right
+    for (size_t i = 0; i < HMAC_SIZE; i++) {
+        diff |= expected[i] ^ mac[i];
+    }
+
+    return diff == 0;
+}
+
+void hmacStart(hmacContext *ctx, const hmacKey *hk) {
+    ctx->key = hk;
+
+    sha256_resume(&ctx->ctx, &hk->inner);
+}
+
+void hmacUpdate(hmacContext *ctx, const uint8_t *message, size_t length) {
+    sha256_hash(&ctx->ctx, message, length);
+}
+
+void hmacFinal(hmacContext *ctx, uint8_t *mac) {
+
+    uint8_t inner[SHA256_SIZE_BYTES];
+
+    sha256_done(&ctx->ctx, inner);
+    sha256_prefixed(&ctx->key->outer, inner, sizeof(inner), mac);
+}
+
+void hkdfExtract(const uint8_t *salt, size_t saltLength, const uint8_t *ikm, size_t ikmLength,
+                 uint8_t *prk) {
+
+    // a missing salt is HMAC_SIZE zeros, which hmacInit zero fills to the same key
+    hmacKey hk;
+
+    hmacInit(&hk, salt, salt ? saltLength : 0);
+    hmacSha256(&hk, ikm, ikmLength, prk);
+}
+
+int hkdfExpand(const hmacKey *prk, const uint8_t *info, size_t infoLength, uint8_t *okm,
+               size_t length) {
+
+    if (length > HKDF_MAX_LENGTH) {
+        fprintf(stderr, "HKDF output too long (max %d bytes)\n", HKDF_MAX_LENGTH);
+
+        return EXIT_FAILURE;
+    }
+
+    // T(i) = HMAC(PRK, T(i - 1) || info || i), with T(0) empty
+    uint8_t t[HMAC_SIZE];
+    uint8_t counter = 1;
+
+    for (size_t done = 0; done < length; done += HMAC_SIZE, counter++) {
+        hmacContext ctx;
+
+        hmacStart(&ctx, prk);
+
+        if (counter > 1) {
+            hmacUpdate(&ctx, t, sizeof(t));
+        }
+
+        hmacUpdate(&ctx, info, infoLength);
+        hmacUpdate(&ctx, &counter, 1);
+        hmacFinal(&ctx, t);
+
+        size_t n = length - done < HMAC_SIZE ? length - done : HMAC_SIZE;
+
+        memcpy(okm + done, t, n);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int hkdfexpandBatch(const hmacKey *prk, const uint8_t *const *infos, const size_t *infoLengths,
+                    uint8_t *okm, size_t length, size_t count) {
+
+    if (length > HKDF_MAX_LENGTH) {
+        fprintf(stderr, "HKDF output too long (max %d bytes)\n", HKDF_MAX_LENGTH);
+
+        return EXIT_FAILURE;
+    }
+
+    size_t maxInfo = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (infoLengths[i] > maxInfo) {
+            maxInfo = infoLengths[i];
+        }
+    }
+
+    // every info gets its own T(i - 1) || info || i, laid out once and reused by
+    // every round, only T and the counter change
+    size_t stride = HMAC_SIZE + maxInfo + 1;
+    uint8_t *scratch = (uint8_t *)malloc(count * stride);
+    const uint8_t **messages = (const uint8_t **)malloc(count * sizeof(uint8_t *));
+    size_t *lengths = (size_t *)malloc(count * sizeof(size_t));
+    uint8_t *inner = (uint8_t *)malloc(count * HMAC_SIZE);
+    uint8_t *t = (uint8_t *)malloc(count * HMAC_SIZE);
+
+    if (!scratch || !messages || !lengths || !inner || !t) {
+        fprintf(stderr, "Memory allocation failed\n");
+
+        free(scratch);
+        free(messages);
+        free(lengths);
+        free(inner);
+        free(t);
+
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        memcpy(scratch + i * stride + HMAC_SIZE, infos[i], infoLengths[i]);
+    }
+
+    uint8_t counter = 1;
+
+    for (size_t done = 0; done < length; done += HMAC_SIZE, counter++) {
+        // inner hashes of every info together
+        for (size_t i = 0; i < count; i++) {
+            uint8_t *entry = scratch + i * stride;
+
+            entry[HMAC_SIZE + infoLengths[i]] = counter;
+
+            messages[i] = counter > 1 ? entry : entry + HMAC_SIZE;
+            lengths[i] = (counter > 1 ? HMAC_SIZE : 0) + infoLengths[i] + 1;
+        }
+
+        sha256multiPrefixed(&prk->inner, messages, lengths, inner, count);
+
+        // then the outer ones, T(i) goes back in front of each info
+        for (size_t i = 0; i < count; i++) {
+            messages[i] = inner + i * HMAC_SIZE;
+            lengths[i] = HMAC_SIZE;
+        }
+
+        sha256multiPrefixed(&prk->outer, messages, lengths, t, count);
+
+        size_t n = length - done < HMAC_SIZE ? length - done : HMAC_SIZE;
+
+        for (size_t i = 0; i < count; i++) {
+            memcpy(scratch + i * stride, t + i * HMAC_SIZE, HMAC_SIZE);
+            memcpy(okm + i * length + done, t + i * HMAC_SIZE, n);
+        }
+    }
+
+    free(scratch);
+    free(messages);
+    free(lengths);
+    free(inner);
+    free(t);
+
+    return EXIT_SUCCESS;
+}
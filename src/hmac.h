@@ -0,0 +1,54 @@
+#ifndef HMAC_H
+#define HMAC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sha256.h"
+
+/*
+    HMAC-SHA256 (RFC 2104) and HKDF (RFC 5869) on top of sha256.c
+
+    HMAC(K, m) = H((K ^ opad) || H((K ^ ipad) || m)), both padded keys are exactly
+    one block, so hmacInit hashes them once into two midstates and every MAC after
+    that only costs the message blocks plus the one outer block.
+*/
+
+#define HMAC_SIZE SHA256_SIZE_BYTES
+// longest HKDF output, 255 blocks of T(i)
+#define HKDF_MAX_LENGTH (255 * HMAC_SIZE)
+
+typedef struct {
+    sha256_midstate inner;
+    sha256_midstate outer;
+} hmacKey;
+
+// incremental MAC over a message that arrives in pieces
+typedef struct {
+    const hmacKey *key;
+    sha256_context ctx;
+} hmacContext;
+
+void hmacInit(hmacKey *hk, const uint8_t *key, size_t keyLength);
+
+void hmacSha256(const hmacKey *hk, const uint8_t *message, size_t length, uint8_t *mac);
+// 1 if mac is right, the comparison takes the same time wherever they differ
+int hmacVerify(const hmacKey *hk, const uint8_t *message, size_t length, const uint8_t *mac);
+
+void hmacStart(hmacContext *ctx, const hmacKey *hk);
+void hmacUpdate(hmacContext *ctx, const uint8_t *message, size_t length);
+void hmacFinal(hmacContext *ctx, uint8_t *mac);
+
+// PRK = HMAC(salt, IKM), no salt means HMAC_SIZE zero bytes
+void hkdfExtract(const uint8_t *salt, size_t saltLength, const uint8_t *ikm, size_t ikmLength,
+                 uint8_t *prk);
+// length bytes of OKM from the PRK (already keyed with hmacInit) and info
+int hkdfExpand(const hmacKey *prk, const uint8_t *info, size_t infoLength, uint8_t *okm,
+               size_t length);
+
+// hkdfExpand for count infos at once (e.g. one per ballot, for its DES key and IV),
+// okm + i * length gets the output of infos[i]. The MACs of all infos go through
+// the multi-buffer SHA-256 together
+int hkdfexpandBatch(const hmacKey *prk, const uint8_t *const *infos, const size_t *infoLengths,
+                    uint8_t *okm, size_t length, size_t count);
+
+#endif
@@ -125,6 +125,25 @@ int main() {
                 return EXIT_FAILURE;
             }
         }
+
+        char hashOption[10];
+
+        printf("1) SHA-256\n");
+        printf("2) SHA-512 (faster on large inputs on 64 bit cores)\n");
+        printf("3) SHA-512/256\n");
+        printf("4) BLAKE3 (internal use only, not a SHA-2)\n");
+
+        getInput("Choose the hash to sign (1-4, default: 1): ", hashOption, sizeof(hashOption));
+
+        if (hashOption[0] == '2') {
+            vote.hash = HASH_SHA512;
+        } else if (hashOption[0] == '3') {
+            vote.hash = HASH_SHA512_256;
+        } else if (hashOption[0] == '4') {
+            vote.hash = HASH_BLAKE3;
+        } else {
+            vote.hash = HASH_SHA256;
+        }
     }
 
     // ------------- DES
@@ -132,29 +151,52 @@ int main() {
     if (vote.mode == MODE_CONFIDENTIALITY || vote.mode == MODE_BOTH) {
         printf("\n------------------------- CONFIDENTIAL MODE -------------------------\n");
 
+        char cipherOption[10];
+
+        printf("1) DES (8 byte key)\n");
+        printf("2) 3DES EDE3 (24 byte key, recommended)\n");
+
+        getInput("Choose a cipher (1-2): ", cipherOption, sizeof(cipherOption));
+
+        vote.cipher = cipherOption[0] == '2' ? CIPHER_3DES : CIPHER_DES;
+
+        size_t keyLength = vote.cipher == CIPHER_3DES ? DES3_KEY_SIZE : 8;
+
         char desOption[10];
 
-        printf("1) Generate random DES key (recommended)\n");
-        printf("2) Provide custom DES key (8 bytes, hex format)\n");
+        printf("1) Generate random key (recommended)\n");
+        printf("2) Provide custom key (%zu bytes, hex format)\n", keyLength);
 
         getInput("Choose an option (1-2): ", desOption, sizeof(desOption));
 
         if (desOption[0] == '1') {
-            genrandomdesKey(vote.des_key);
+            if (vote.cipher == CIPHER_3DES) {
+                genrandomdes3Key(vote.des_key);
+            } else {
+                genrandomdesKey(vote.des_key);
+            }
 
-            printf("The generated DES key: ");
+            printf("The generated key: ");
 
-            printHex(vote.des_key, 8);
+            printHex(vote.des_key, keyLength);
         } else {
             // let user input
 
-            char deskeyHex[20];
-            getInput("Enter DES key (16 hex characters): ", deskeyHex, sizeof(deskeyHex));
+            char deskeyHex[64];
+            getInput("Enter key (hex characters): ", deskeyHex, sizeof(deskeyHex));
+
+            // fgets keeps the newline
+            deskeyHex[strcspn(deskeyHex, "\n")] = '\0';
 
-            if (strlen(deskeyHex) != 16 || !hextoBytes(deskeyHex, vote.des_key, 8)) {
+            if (strlen(deskeyHex) != keyLength * 2 ||
+                hextoBytes(deskeyHex, vote.des_key, keyLength) != EXIT_SUCCESS) {
                 printf("you can't even specify a simple key, just using a random key.\n");
 
-                genrandomdesKey(vote.des_key);
+                if (vote.cipher == CIPHER_3DES) {
+                    genrandomdes3Key(vote.des_key);
+                } else {
+                    genrandomdesKey(vote.des_key);
+                }
             }
         }
 
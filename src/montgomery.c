@@ -0,0 +1,314 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "montgomery.h"
+
+// https://gmplib.org/manual/Low_002dlevel-Functions
+// https://en.wikipedia.org/wiki/Montgomery_modular_multiplication
+
+// 2^(MAX_WINDOW - 1) table entries at most
+#define MAX_WINDOW 7
+
+// the window grows by one bit past each of these exponent sizes (GMP's choice)
+static const size_t windowLimits[MAX_WINDOW - 1] = { 7, 25, 81, 241, 673, 1793 };
+
+int montInit(montContext *ctx, const mpz_t modulus) {
+
+    montReset(ctx);
+
+    mp_size_t size = (mp_size_t)mpz_size(modulus);
+
+    if (mpz_sgn(modulus) <= 0 || mpz_even_p(modulus) || mpz_cmp_ui(modulus, 1) == 0 ||
+        size > MONT_MAX_LIMBS) {
+        return EXIT_FAILURE;
+    }
+
+    mpn_copyi(ctx->n, mpz_limbs_read(modulus), size);
+
+    // Newton's iteration for n^-1 mod 2^64, every step doubles the correct bits
+    // (n * n = 1 mod 8 for odd n, so n is already right in 3 bits)
+    mp_limb_t inverse = ctx->n[0];
+
+    for (int i = 0; i < 6; i++) {
+        inverse *= 2 - ctx->n[0] * inverse;
+    }
+
+    ctx->nInv = -inverse;
+
+    // R^2 mod n, once per key so the division does not matter
+    mpz_t rr;
+
+    mpz_init(rr);
+    mpz_setbit(rr, 2 * GMP_NUMB_BITS * size);
+    mpz_mod(rr, rr, modulus);
+
+    mpn_zero(ctx->rr, size);
+    mpn_copyi(ctx->rr, mpz_limbs_read(rr), (mp_size_t)mpz_size(rr));
+
+    mpz_clear(rr);
+
+    ctx->size = size;
+
+    return EXIT_SUCCESS;
+}
+
+void montReset(montContext *ctx) {
+    ctx->size = 0;
+}
+
+int montMatches(const montContext *ctx, const mpz_t modulus) {
+    return ctx->size > 0 && (mp_size_t)mpz_size(modulus) == ctx->size &&
+           mpz_sgn(modulus) > 0 && mpn_cmp(ctx->n, mpz_limbs_read(modulus), ctx->size) == 0;
+}
+
+// result = t * R^-1 mod n, t has 2 * size limbs and is destroyed
+static void redc(const montContext *ctx, mp_limb_t *result, mp_limb_t *t) {
+
+    mp_size_t size = ctx->size;
+
+    // clear the low limbs one at a time, the carry out of each step is parked in
+    // the limb that was just cleared and added in at the end (like GMP's redc_1)
+    for (mp_size_t i = 0; i < size; i++) {
+        mp_limb_t q = t[i] * ctx->nInv;
+
+        t[i] = mpn_addmul_1(t + i, ctx->n, size, q);
+    }
+
+    mp_limb_t carry = mpn_add_n(result, t + size, t, size);
+
+    // below 2n, one subtraction is enough
+    if (carry || mpn_cmp(result, ctx->n, size) >= 0) {
+        mpn_sub_n(result, result, ctx->n, size);
+    }
+}
+
+// result = a * b * R^-1 mod n, result may be a or b
+static inline void montMul(const montContext *ctx, mp_limb_t *result, const mp_limb_t *a,
+                           const mp_limb_t *b, mp_limb_t *t) {
+
+    if (a == b) {
+        mpn_sqr(t, a, ctx->size);
+    } else {
+        mpn_mul_n(t, a, b, ctx->size);
+    }
+
+    redc(ctx, result, t);
+}
+
+// result = a * R^-1 mod n, out of Montgomery form
+static void fromMont(const montContext *ctx, mp_limb_t *result, const mp_limb_t *a,
+                     mp_limb_t *t) {
+
+    mpn_copyi(t, a, ctx->size);
+    mpn_zero(t + ctx->size, ctx->size);
+
+    redc(ctx, result, t);
+}
+
+void montReduce(const montContext *ctx, mp_limb_t *result, const mp_limb_t *x,
+                mp_size_t xSize) {
+
+    mp_size_t size = ctx->size;
+
+    // fewer limbs than n (whose top limb is not 0) is already reduced, and
+    // signatures are checked to be below n, so skip the division for those too
+    if (xSize < size || (xSize == size && mpn_cmp(x, ctx->n, size) < 0)) {
+        mpn_zero(result, size);
+
+        if (xSize > 0) {
+            mpn_copyi(result, x, xSize);
+        }
+
+        return;
+    }
+
+    mp_limb_t quotient[2 * MONT_MAX_LIMBS + 1];
+
+    mpn_tdiv_qr(quotient, result, 0, x, xSize, ctx->n, size);
+}
+
+static inline unsigned int exponentBit(const mp_limb_t *exponent, size_t bit) {
+    return (unsigned int)(exponent[bit / GMP_NUMB_BITS] >> (bit % GMP_NUMB_BITS)) & 1;
+}
+
+// count <= MAX_WINDOW bits of exponent from bit `low`, all below its top bit
+static inline unsigned int exponentBits(const mp_limb_t *exponent, size_t low, int count) {
+
+    unsigned int bits = 0;
+
+    for (int i = count - 1; i >= 0; i--) {
+        bits = (bits << 1) | exponentBit(exponent, low + (size_t)i);
+    }
+
+    return bits;
+}
+
+// k if the exponent is 2^k + 1 (3, 17, 257, 65537, the usual public exponents), else 0
+static int fermatExponent(const mp_limb_t *exponent, mp_size_t exponentSize) {
+
+    if (exponentSize != 1 || exponent[0] < 3) {
+        return 0;
+    }
+
+    mp_limb_t power = exponent[0] - 1;
+
+    if ((power & (power - 1)) != 0) {
+        return 0;
+    }
+
+    int k = 0;
+
+    while (power > 1) {
+        power >>= 1;
+        k++;
+    }
+
+    return k;
+}
+
+// result = base^(2^k + 1) mod n by the addition chain 1, 2, 4, .., 2^k, 2^k + 1:
+// k squarings and one multiplication, where the sliding window would also
+// build a table it barely uses (16 squarings and 1 multiplication for 65537)
+static void powerFermat(const montContext *ctx, mp_limb_t *result, const mp_limb_t *base,
+                        int k) {
+
+    mp_limb_t t[2 * MONT_MAX_LIMBS];
+    mp_limb_t x[MONT_MAX_LIMBS];
+    mp_limb_t acc[MONT_MAX_LIMBS];
+
+    montMul(ctx, x, base, ctx->rr, t);
+    montMul(ctx, acc, x, x, t);
+
+    for (int i = 1; i < k; i++) {
+        montMul(ctx, acc, acc, acc, t);
+    }
+
+    montMul(ctx, acc, acc, x, t);
+
+    fromMont(ctx, result, acc, t);
+}
+
+void montpowmLimbs(const montContext *ctx, mp_limb_t *result, const mp_limb_t *base,
+                   const mp_limb_t *exponent, mp_size_t exponentSize) {
+
+    mp_size_t size = ctx->size;
+    mp_limb_t t[2 * MONT_MAX_LIMBS];
+    mp_limb_t acc[MONT_MAX_LIMBS];
+    // 2^(window - 1) entries of size limbs each, packed so small moduli stay in cache
+    mp_limb_t table[(1 << (MAX_WINDOW - 1)) * MONT_MAX_LIMBS];
+
+    while (exponentSize > 0 && exponent[exponentSize - 1] == 0) {
+        exponentSize--;
+    }
+
+    size_t bits = 0;
+
+    if (exponentSize > 0) {
+        bits = (size_t)(exponentSize - 1) * GMP_NUMB_BITS;
+
+        for (mp_limb_t top = exponent[exponentSize - 1]; top != 0; top >>= 1) {
+            bits++;
+        }
+    }
+
+    // x^0 = 1 (0 for n = 1, which montInit does not take)
+    if (bits == 0) {
+        mpn_zero(result, size);
+        result[0] = 1;
+
+        return;
+    }
+
+    int k = fermatExponent(exponent, exponentSize);
+
+    if (k > 0) {
+        powerFermat(ctx, result, base, k);
+
+        return;
+    }
+
+    // short exponents (like e = 65537) use a small table, long ones (the CRT
+    // halves of d) a larger one to save multiplications
+    int window = 1;
+
+    while (window < MAX_WINDOW && bits > windowLimits[window - 1]) {
+        window++;
+    }
+
+    // sliding window, every window ends in a 1 bit so only the odd powers are
+    // needed: entry i = base^(2i + 1) * R mod n
+    montMul(ctx, table, base, ctx->rr, t);
+
+    if (window > 1) {
+        mp_limb_t square[MONT_MAX_LIMBS];
+
+        montMul(ctx, square, table, table, t);
+
+        for (int i = 1; i < (1 << (window - 1)); i++) {
+            montMul(ctx, table + i * size, table + (i - 1) * size, square, t);
+        }
+    }
+
+    // left to right, the top bit is 1 so the first window starts the result
+    int first = 1;
+    size_t top = bits;
+
+    while (top > 0) {
+        if (!exponentBit(exponent, top - 1)) {
+            montMul(ctx, acc, acc, acc, t);
+            top--;
+
+            continue;
+        }
+
+        // the longest window from bit top - 1 down that ends in a 1
+        size_t low = top > (size_t)window ? top - (size_t)window : 0;
+
+        while (!exponentBit(exponent, low)) {
+            low++;
+        }
+
+        int count = (int)(top - low);
+        unsigned int digit = exponentBits(exponent, low, count);
+
+        if (first) {
+            mpn_copyi(acc, table + (digit >> 1) * size, size);
+            first = 0;
+        } else {
+            for (int i = 0; i < count; i++) {
+                montMul(ctx, acc, acc, acc, t);
+            }
+
+            montMul(ctx, acc, acc, table + (digit >> 1) * size, t);
+        }
+
+        top = low;
+    }
+
+    fromMont(ctx, result, acc, t);
+}
+
+void montPowm(const montContext *ctx, mpz_t result, const mpz_t base, const mpz_t exponent) {
+
+    mp_size_t size = ctx->size;
+    mp_size_t baseSize = (mp_size_t)mpz_size(base);
+
+    // nothing in RSA gets here, but stay correct
+    if (mpz_sgn(base) < 0 || mpz_sgn(exponent) < 0 || baseSize > 2 * MONT_MAX_LIMBS) {
+        mpz_t modulus;
+
+        mpz_powm(result, base, exponent, mpz_roinit_n(modulus, ctx->n, size));
+
+        return;
+    }
+
+    mp_limb_t reduced[MONT_MAX_LIMBS];
+
+    montReduce(ctx, reduced, mpz_limbs_read(base), baseSize);
+
+    // only allocates when result is smaller than the modulus
+    mp_limb_t *out = mpz_limbs_write(result, size);
+
+    montpowmLimbs(ctx, out, reduced, mpz_limbs_read(exponent), (mp_size_t)mpz_size(exponent));
+
+    mpz_limbs_finish(result, size);
+}
@@ -0,0 +1,50 @@
+#ifndef MONTGOMERY_H
+#define MONTGOMERY_H
+
+#include <gmp.h>
+
+/*
+    Modular exponentiation with a fixed odd modulus on GMP's mpn layer
+
+    mpz_powm works out its Montgomery setup (inverse of the modulus, R^2 mod n) and
+    allocates its scratch on every call. A montContext keeps the setup of one
+    modulus, done once when the key is made, and montPowm runs with all its
+    scratch on the stack, so the RSA hot path does not touch the heap.
+
+    Moduli up to MONT_MAX_BITS (1024, 2048 and 4096 bit keys and their CRT halves),
+    the window of the exponentiation is chosen for the size of the exponent, and
+    exponents 2^k + 1 (e = 65537) take a fixed chain of k squarings and 1 multiply.
+    A context is only read after montInit, threads can share it.
+*/
+
+#define MONT_MAX_BITS 4096
+#define MONT_MAX_LIMBS (MONT_MAX_BITS / GMP_NUMB_BITS)
+
+typedef struct {
+    // limbs of the modulus, 0 if the context is not set up
+    mp_size_t size;
+    mp_limb_t n[MONT_MAX_LIMBS];
+    // -n^-1 mod 2^GMP_NUMB_BITS
+    mp_limb_t nInv;
+    // R^2 mod n with R = 2^(GMP_NUMB_BITS * size), to move into Montgomery form
+    mp_limb_t rr[MONT_MAX_LIMBS];
+} montContext;
+
+// EXIT_FAILURE (and an unset context) for an even, too small or too large modulus
+int montInit(montContext *ctx, const mpz_t modulus);
+void montReset(montContext *ctx);
+// 1 if the context was set up for this modulus
+int montMatches(const montContext *ctx, const mpz_t modulus);
+
+// result = base^exponent mod n, any size of base, result must be initialised
+void montPowm(const montContext *ctx, mpz_t result, const mpz_t base, const mpz_t exponent);
+
+// the same on limbs: result and base have ctx->size limbs, base < n
+void montpowmLimbs(const montContext *ctx, mp_limb_t *result, const mp_limb_t *base,
+                   const mp_limb_t *exponent, mp_size_t exponentSize);
+
+// result (ctx->size limbs) = x mod n for an x of xSize <= 2 * MONT_MAX_LIMBS limbs
+void montReduce(const montContext *ctx, mp_limb_t *result, const mp_limb_t *x,
+                mp_size_t xSize);
+
+#endif
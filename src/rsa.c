@@ -18,6 +18,14 @@ void rsainitkeyPair(rsakeyPair *keyPair) {
     mpz_init(keyPair->q);
     // phi(n) = (p-1)*(q-1)
     mpz_init(keyPair->phi);
+    // CRT values, d mod (p-1), d mod (q-1) and q^-1 mod p
+    mpz_init(keyPair->dp);
+    mpz_init(keyPair->dq);
+    mpz_init(keyPair->qInv);
+    // no Montgomery contexts until the key has its numbers
+    montReset(&keyPair->montN);
+    montReset(&keyPair->montP);
+    montReset(&keyPair->montQ);
 }
 
 void rsaclearkeyPair(rsakeyPair *keyPair) {
@@ -27,6 +35,9 @@ void rsaclearkeyPair(rsakeyPair *keyPair) {
     mpz_clear(keyPair->p);
     mpz_clear(keyPair->q);
     mpz_clear(keyPair->phi);
+    mpz_clear(keyPair->dp);
+    mpz_clear(keyPair->dq);
+    mpz_clear(keyPair->qInv);
 }
 
 int isPrime(const char *numStr) {
@@ -135,7 +146,8 @@ int rsagenkeyPair(rsakeyPair *keyPair, const char *p_str, const char *q_str, con
 
     // now we calc private key (d), d = e^-1 mod phi(n)
     // if modInverse fails, we can't calc d
-    if (!modInverse(keyPair->d, keyPair->e, keyPair->phi)) {
+    if (modInverse(keyPair->d, keyPair->e, keyPair->phi) != EXIT_SUCCESS ||
+        rsacomputeCrt(keyPair) != EXIT_SUCCESS) {
         fprintf(stderr, "Failed to calculate modular inverse\n");
 
         mpz_clear(pMinus1);
@@ -153,6 +165,167 @@ int rsagenkeyPair(rsakeyPair *keyPair, const char *p_str, const char *q_str, con
     return EXIT_SUCCESS;
 }
 
+int rsacomputeCrt(rsakeyPair *keyPair) {
+
+    mpz_t pMinus1, qMinus1;
+
+    mpz_init(pMinus1);
+    mpz_init(qMinus1);
+
+    mpz_sub_ui(pMinus1, keyPair->p, 1);
+    mpz_sub_ui(qMinus1, keyPair->q, 1);
+
+    // the exponents only matter mod p-1 and mod q-1 (Fermat), so half size
+    mpz_mod(keyPair->dp, keyPair->d, pMinus1);
+    mpz_mod(keyPair->dq, keyPair->d, qMinus1);
+
+    int ok = mpz_invert(keyPair->qInv, keyPair->q, keyPair->p) != 0;
+
+    mpz_clear(pMinus1);
+    mpz_clear(qMinus1);
+
+    rsapreparePublic(keyPair);
+
+    // a modulus the contexts cannot take (even, too large) just stays on mpz_powm
+    if (!ok || montInit(&keyPair->montP, keyPair->p) != EXIT_SUCCESS ||
+        montInit(&keyPair->montQ, keyPair->q) != EXIT_SUCCESS) {
+        montReset(&keyPair->montP);
+        montReset(&keyPair->montQ);
+    }
+
+    if (!ok) {
+        // leave the key without CRT values, the private key operations then use d
+        mpz_set_ui(keyPair->dp, 0);
+        mpz_set_ui(keyPair->dq, 0);
+        mpz_set_ui(keyPair->qInv, 0);
+
+        fprintf(stderr, "q is not invertible mod p\n");
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+void rsapreparePublic(rsakeyPair *keyPair) {
+
+    if (montInit(&keyPair->montN, keyPair->n) != EXIT_SUCCESS) {
+        montReset(&keyPair->montN);
+    }
+}
+
+// x (a hash, at most MONT_MAX_BITS) as a read only mpz on limbs, limbs has
+// MONT_MAX_LIMBS + 1 of them, 0 if it does not fit
+static int importHash(mpz_t x, mp_limb_t *limbs, const unsigned char *hash, size_t hashLength) {
+
+    // mpn_set_str wants the top byte to be non zero
+    while (hashLength > 0 && hash[0] == 0) {
+        hash++;
+        hashLength--;
+    }
+
+    if (hashLength > MONT_MAX_LIMBS * sizeof(mp_limb_t)) {
+        return 0;
+    }
+
+    mp_size_t size = hashLength > 0 ? mpn_set_str(limbs, hash, hashLength, 256) : 0;
+
+    mpz_roinit_n(x, limbs, size);
+
+    return 1;
+}
+
+// x^d mod n by CRT on the contexts of p and q, all on the stack, 0 if the key
+// does not have them
+static int privatePowerMont(mpz_t result, const mpz_t x, const rsakeyPair *keyPair) {
+
+    const montContext *ctxP = &keyPair->montP;
+    const montContext *ctxQ = &keyPair->montQ;
+
+    if (!montMatches(ctxP, keyPair->p) || !montMatches(ctxQ, keyPair->q) ||
+        mpz_sgn(x) < 0 || mpz_size(x) > 2 * MONT_MAX_LIMBS) {
+        return 0;
+    }
+
+    mp_size_t pSize = ctxP->size;
+    mp_size_t qSize = ctxQ->size;
+    mp_size_t qInvSize = (mp_size_t)mpz_size(keyPair->qInv);
+    mp_limb_t reduced[MONT_MAX_LIMBS];
+    mp_limb_t m1[MONT_MAX_LIMBS];
+    mp_limb_t m2[MONT_MAX_LIMBS];
+    mp_limb_t h[MONT_MAX_LIMBS];
+    mp_limb_t product[2 * MONT_MAX_LIMBS];
+
+    montReduce(ctxP, reduced, mpz_limbs_read(x), (mp_size_t)mpz_size(x));
+    montpowmLimbs(ctxP, m1, reduced, mpz_limbs_read(keyPair->dp),
+                  (mp_size_t)mpz_size(keyPair->dp));
+
+    montReduce(ctxQ, reduced, mpz_limbs_read(x), (mp_size_t)mpz_size(x));
+    montpowmLimbs(ctxQ, m2, reduced, mpz_limbs_read(keyPair->dq),
+                  (mp_size_t)mpz_size(keyPair->dq));
+
+    // Garner as below: h = qInv * (m1 - m2) mod p, both sides already below p
+    montReduce(ctxP, h, m2, qSize);
+
+    if (mpn_sub_n(h, m1, h, pSize)) {
+        mpn_add_n(h, h, ctxP->n, pSize);
+    }
+
+    // qInv < p, so it is never the longer operand
+    mpn_mul(product, h, pSize, mpz_limbs_read(keyPair->qInv), qInvSize);
+    montReduce(ctxP, h, product, pSize + qInvSize);
+
+    // result = m2 + q * h < n, the addition cannot carry out
+    if (qSize >= pSize) {
+        mpn_mul(product, ctxQ->n, qSize, h, pSize);
+    } else {
+        mpn_mul(product, h, pSize, ctxQ->n, qSize);
+    }
+
+    mpn_add(product, product, pSize + qSize, m2, qSize);
+
+    // result only allocates when it is smaller than n
+    mpn_copyi(mpz_limbs_write(result, pSize + qSize), product, pSize + qSize);
+    mpz_limbs_finish(result, pSize + qSize);
+
+    return 1;
+}
+
+// result = x^d mod n, with the CRT values when the key has them
+// (https://en.wikipedia.org/wiki/RSA_(cryptosystem)#Using_the_Chinese_remainder_algorithm)
+static void privatePower(mpz_t result, const mpz_t x, const rsakeyPair *keyPair) {
+
+    if (mpz_sgn(keyPair->qInv) != 0 && privatePowerMont(result, x, keyPair)) {
+        return;
+    }
+
+    if (mpz_sgn(keyPair->qInv) == 0) {
+        mpz_powm(result, x, keyPair->d, keyPair->n);
+
+        return;
+    }
+
+    mpz_t m1, m2;
+
+    mpz_init(m1);
+    mpz_init(m2);
+
+    // two exponentiations with half size moduli and exponents, about 4 times less
+    // work than one with d mod n
+    mpz_powm(m1, x, keyPair->dp, keyPair->p);
+    mpz_powm(m2, x, keyPair->dq, keyPair->q);
+
+    // Garner: result = m2 + q * (qInv * (m1 - m2) mod p)
+    mpz_sub(m1, m1, m2);
+    mpz_mul(m1, m1, keyPair->qInv);
+    mpz_mod(m1, m1, keyPair->p);
+    mpz_mul(m1, m1, keyPair->q);
+    mpz_add(result, m2, m1);
+
+    mpz_clear(m1);
+    mpz_clear(m2);
+}
+
 // c = m^e mod n
 int rsaEncrypt(const rsakeyPair *keyPair, const unsigned char *message, size_t messageLen,
                 mpz_t *encrypted) {
@@ -178,7 +351,11 @@ int rsaEncrypt(const rsakeyPair *keyPair, const unsigned char *message, size_t m
     mpz_init(*encrypted);
 
     // square and multiply c = m^e mod n
-    mpz_powm(*encrypted, m, keyPair->e, keyPair->n);
+    if (montMatches(&keyPair->montN, keyPair->n)) {
+        montPowm(&keyPair->montN, *encrypted, m, keyPair->e);
+    } else {
+        mpz_powm(*encrypted, m, keyPair->e, keyPair->n);
+    }
 
     mpz_clear(m);
 
@@ -200,7 +377,7 @@ int rsaDecrypt(const rsakeyPair *keyPair, const mpz_t encrypted, unsigned char *
     mpz_t m;
     mpz_init(m);
 
-    mpz_powm(m, encrypted, keyPair->d, keyPair->n);
+    privatePower(m, encrypted, keyPair);
 
     // get size of decrypted msg and store in bufferSize
     // (m,2) + 7) / 8, get num of bytes needed to store m in binary
@@ -230,33 +407,58 @@ int rsaDecrypt(const rsakeyPair *keyPair, const mpz_t encrypted, unsigned char *
     return EXIT_SUCCESS;
 }
 
+int rsacanonicalSignature(const rsakeyPair *keyPair, const mpz_t signature) {
+
+    if (mpz_sgn(signature) < 0 || mpz_cmp(signature, keyPair->n) >= 0) {
+        return 0;
+    }
+
+    mp_size_t size = (mp_size_t)mpz_size(signature);
+
+    if (size == 0) {
+        return 1;
+    }
+
+    // 2s <= n, on the stack for the key sizes with a context
+    if (size <= MONT_MAX_LIMBS) {
+        mp_limb_t twice[MONT_MAX_LIMBS + 1];
+        mpz_t doubled;
+
+        twice[size] = mpn_lshift(twice, mpz_limbs_read(signature), size, 1);
+
+        return mpz_cmp(mpz_roinit_n(doubled, twice, size + 1), keyPair->n) <= 0;
+    }
+
+    mpz_t doubled;
+
+    mpz_init(doubled);
+    mpz_mul_2exp(doubled, signature, 1);
+
+    int result = mpz_cmp(doubled, keyPair->n) <= 0;
+
+    mpz_clear(doubled);
+
+    return result;
+}
+
 // signedMessage = hash^d mod n
 int rsaSign(const rsakeyPair *keyPair, const unsigned char *hash, size_t hashLength,
              mpz_t *signature) {
 
     mpz_t h;
+    mp_limb_t limbs[MONT_MAX_LIMBS + 1];
 
-    mpz_init(h);
-
-    // store result in h, hash length bytes to import, 1 as single block, 1 each block 1 byte, 1 for big endian and 0 for no padding
-    // big endian is used for compatibility with SHA-256 output
-    mpz_import(h, hashLength, 1, 1, 1, 0, hash);
-
+    // big endian is used for compatibility with the hash output, read into limbs on
+    // the stack instead of mpz_import so nothing is allocated
     // IMPORTANT: Check that h < n
-    if (mpz_cmp(h, keyPair->n) >= 0) {
-        fprintf(stderr, "SHA-256 hash is too large for the given key (n = p x q) %s\n", mpz_get_str(NULL, 10, keyPair->n));
-
-        mpz_clear(h);
+    if (!importHash(h, limbs, hash, hashLength) || mpz_cmp(h, keyPair->n) >= 0) {
+        fprintf(stderr, "Hash is too large for the given key\n");
 
         return EXIT_FAILURE;
     }
 
-    mpz_init(*signature);
-
-    // square and multiply, signature = h^d mod n
-    mpz_powm(*signature, h, keyPair->d, keyPair->n);
-
-    mpz_clear(h);
+    // signature is initialised by the caller, square and multiply, signature = h^d mod n
+    privatePower(*signature, h, keyPair);
 
     return EXIT_SUCCESS;
 }
@@ -268,27 +470,52 @@ int rsaVerify(const rsakeyPair *keyPair, const unsigned char *hash, size_t hashL
     if (mpz_cmp(signature, keyPair->n) >= 0) {
         fprintf(stderr, "Signature is too large for the given key\n");
 
-        return EXIT_FAILURE;
+        // not EXIT_FAILURE, that is 1 and would read as valid
+        return 0;
     }
 
-    // calc h' = signature^e mod n
-    mpz_t hashPrime;
+    // original hash, one longer than any key cannot match
+    mpz_t h;
+    mp_limb_t limbs[MONT_MAX_LIMBS + 1];
 
-    mpz_init(hashPrime);
-    mpz_powm(hashPrime, signature, keyPair->e, keyPair->n);
+    if (!importHash(h, limbs, hash, hashLength)) {
+        return 0;
+    }
 
-    // original hash
-    mpz_t h;
+    const montContext *ctx = &keyPair->montN;
+
+    // calc h' = signature^e mod n, on the stack with the context of n
+    if (montMatches(ctx, keyPair->n)) {
+        mp_limb_t base[MONT_MAX_LIMBS];
+        mp_limb_t power[MONT_MAX_LIMBS];
+        mpz_t hashPrime;
 
-    mpz_init(h);
+        montReduce(ctx, base, mpz_limbs_read(signature), (mp_size_t)mpz_size(signature));
+        montpowmLimbs(ctx, power, base, mpz_limbs_read(keyPair->e),
+                      (mp_size_t)mpz_size(keyPair->e));
 
-    mpz_import(h, hashLength, 1, 1, 1, 0, hash);
+        // compare h' and h (or n - h'), if they are equal, the signature is valid.
+        // n - s of a valid s gives -h, accepted so that rsaverifyBatch, which
+        // cannot tell the two apart, always agrees
+        if (mpz_cmp(h, mpz_roinit_n(hashPrime, power, ctx->size)) == 0) {
+            return 1;
+        }
+
+        mpn_sub_n(power, ctx->n, power, ctx->size);
+
+        return mpz_cmp(h, mpz_roinit_n(hashPrime, power, ctx->size)) == 0;
+    }
+
+    mpz_t hashPrime;
+
+    mpz_init(hashPrime);
+    mpz_powm(hashPrime, signature, keyPair->e, keyPair->n);
 
-    // compare h' and h
-    // if they are equal, the signature is valid
     int result = (mpz_cmp(h, hashPrime) == 0);
 
-    mpz_clear(h);
+    mpz_sub(hashPrime, keyPair->n, hashPrime);
+    result |= (mpz_cmp(h, hashPrime) == 0);
+
     mpz_clear(hashPrime);
 
     return result;
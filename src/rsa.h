@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <gmp.h>
+#include "montgomery.h"
 
 /*
     sudo apt install libgmp-dev
@@ -19,6 +20,16 @@ typedef struct {
     mpz_t p;
     mpz_t q;
     mpz_t phi;
+    // CRT form of d for the private key operations, dp = d mod (p-1),
+    // dq = d mod (q-1), qInv = q^-1 mod p (all 0 until rsacomputeCrt)
+    mpz_t dp;
+    mpz_t dq;
+    mpz_t qInv;
+    // Montgomery set up of n, p and q (rsacomputeCrt, rsapreparePublic), the
+    // exponentiations fall back to mpz_powm when a context does not match its number
+    montContext montN;
+    montContext montP;
+    montContext montQ;
 } rsakeyPair;
 
 void rsainitkeyPair(rsakeyPair *keyPair);
@@ -27,12 +38,25 @@ void rsaclearkeyPair(rsakeyPair *keyPair);
 
 int rsagenkeyPair(rsakeyPair *keyPair, const char *p_str, const char *q_str, const char *e_str);
 
+// fill in dp, dq and qInv from d, p and q, the key generators already do it,
+// keys read or set by hand need it to get the faster private key operations
+int rsacomputeCrt(rsakeyPair *keyPair);
+
+// set up the context of n for a key that only has n and e (rsacomputeCrt does it too)
+void rsapreparePublic(rsakeyPair *keyPair);
+
 int rsaEncrypt(const rsakeyPair *keyPair, const unsigned char *message, size_t messageLen,
                 mpz_t *encrypted);
 
 int rsaDecrypt(const rsakeyPair *keyPair, const mpz_t encrypted, unsigned char **decrypted,
                 size_t *decryptedLen);
 
+// 1 if 0 <= signature <= n / 2. rsaVerify accepts s^e = h and s^e = -h (mod n),
+// so s and n - s both verify, rsaverifyBatch folds every signature to this form
+// before its product test
+int rsacanonicalSignature(const rsakeyPair *keyPair, const mpz_t signature);
+
+// hashes of up to MONT_MAX_BITS / 8 bytes, they are read without touching the heap
 int rsaSign(const rsakeyPair *keyPair, const unsigned char *hash, size_t hashLength,
              mpz_t *signature);
 
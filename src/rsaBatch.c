@@ -0,0 +1,395 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "rsaBatch.h"
+
+// https://cseweb.ucsd.edu/~mihir/papers/batch.pdf (small exponents test, screening)
+
+// ranges this small are checked pair by pair
+#define BATCH_LEAF 4
+
+// whole batches this small too, setting up a screen costs about 8 verifications
+#define BATCH_MIN 8
+
+// at most 2^MAX_WINDOW buckets
+#define MAX_WINDOW 12
+
+typedef struct {
+    const rsakeyPair *keyPair;
+    mpz_srcptr *hashes;
+    const mpz_srcptr *signatures;
+    uint64_t *exponents;
+    int *valid;
+    // only the buckets of the largest window used so far are initialised
+    mpz_t buckets[1 << MAX_WINDOW];
+    int used[1 << MAX_WINDOW];
+    size_t bucketCount;
+    mpz_t running;
+    mpz_t sum;
+    mpz_t left;
+    mpz_t right;
+    // opened on the first screen, small batches never need it
+    FILE *urandom;
+    int urandomTried;
+    // only without /dev/urandom, seeding the Mersenne Twister alone costs
+    // as much as a whole batch of 50 pairs
+    gmp_randstate_t random;
+    int fallback;
+} batchState;
+
+// count fresh exponents, they only have to be unpredictable to whoever made the
+// signatures
+static void randomExponents(batchState *st, size_t count) {
+
+    if (!st->urandomTried) {
+        st->urandom = fopen("/dev/urandom", "rb");
+        st->urandomTried = 1;
+
+        // one read per screen, no 4 KB buffer to fill first
+        if (st->urandom) {
+            setvbuf(st->urandom, NULL, _IONBF, 0);
+        }
+    }
+
+    if (st->urandom &&
+        fread(st->exponents, sizeof(uint64_t), count, st->urandom) == count) {
+        return;
+    }
+
+    if (!st->fallback) {
+        gmp_randinit_default(st->random);
+        gmp_randseed_ui(st->random, (unsigned long)time(NULL) ^ (unsigned long)clock());
+        st->fallback = 1;
+    }
+
+    for (size_t k = 0; k < count; k++) {
+        st->exponents[k] = ((uint64_t)gmp_urandomb_ui(st->random, 32) << 32) |
+                           (uint64_t)gmp_urandomb_ui(st->random, 32);
+    }
+}
+
+static inline void mulMod(mpz_t result, const mpz_t a, const mpz_t b, const mpz_t n) {
+    mpz_mul(result, a, b);
+    mpz_mod(result, result, n);
+}
+
+// result = x^e mod n, e = 65537 goes through the addition chain of the key's context
+static inline void publicPower(const rsakeyPair *keyPair, mpz_t result, const mpz_t x) {
+
+    if (montMatches(&keyPair->montN, keyPair->n)) {
+        montPowm(&keyPair->montN, result, x, keyPair->e);
+    } else {
+        mpz_powm(result, x, keyPair->e, keyPair->n);
+    }
+}
+
+// bucket window with the fewest multiplications for count bases
+static int bestWindow(size_t count) {
+
+    int best = 1;
+    double bestCost = 0;
+
+    for (int window = 1; window <= MAX_WINDOW; window++) {
+        int windows = (RSA_BATCH_BITS + window - 1) / window;
+        double cost = (double)windows * ((double)count + (double)(2u << window));
+
+        if (window == 1 || cost < bestCost) {
+            best = window;
+            bestCost = cost;
+        }
+    }
+
+    return best;
+}
+
+// result = prod bases[first + k]^exponents[k] mod n, window bits of every exponent
+// at a time: each base goes into the bucket of its digit, and the buckets are
+// added up with a running product (Pippenger), the squarings are shared by all
+static void multiPower(batchState *st, mpz_t result, const mpz_srcptr *bases, size_t first,
+                       size_t count) {
+
+    const mpz_srcptr n = st->keyPair->n;
+    int window = bestWindow(count);
+    int haveResult = 0;
+
+    while (st->bucketCount < ((size_t)1 << window)) {
+        mpz_init(st->buckets[st->bucketCount++]);
+    }
+
+    for (int top = RSA_BATCH_BITS; top > 0; top -= window) {
+        int width = top < window ? top : window;
+        int shift = top - width;
+        uint64_t mask = ((uint64_t)1 << width) - 1;
+
+        if (haveResult) {
+            for (int i = 0; i < width; i++) {
+                mulMod(result, result, result, n);
+            }
+        }
+
+        for (uint64_t d = 1; d <= mask; d++) {
+            st->used[d] = 0;
+        }
+
+        for (size_t k = 0; k < count; k++) {
+            uint64_t d = (st->exponents[k] >> shift) & mask;
+
+            if (d == 0) {
+                continue;
+            }
+
+            if (st->used[d]) {
+                mulMod(st->buckets[d], st->buckets[d], bases[first + k], n);
+            } else {
+                mpz_set(st->buckets[d], bases[first + k]);
+                st->used[d] = 1;
+            }
+        }
+
+        // bucket d has to count d times: the running product from the top digit
+        // down holds every bucket >= d, and is multiplied into the sum once per d
+        int haveRunning = 0;
+        int haveSum = 0;
+
+        for (uint64_t d = mask; d >= 1; d--) {
+            if (st->used[d]) {
+                if (haveRunning) {
+                    mulMod(st->running, st->running, st->buckets[d], n);
+                } else {
+                    mpz_set(st->running, st->buckets[d]);
+                    haveRunning = 1;
+                }
+            }
+
+            if (haveRunning) {
+                if (haveSum) {
+                    mulMod(st->sum, st->sum, st->running, n);
+                } else {
+                    mpz_set(st->sum, st->running);
+                    haveSum = 1;
+                }
+            }
+        }
+
+        if (haveSum) {
+            if (haveResult) {
+                mulMod(result, result, st->sum, n);
+            } else {
+                mpz_set(result, st->sum);
+                haveResult = 1;
+            }
+        }
+    }
+
+    if (!haveResult) {
+        mpz_set_ui(result, 1);
+    }
+}
+
+// 1 if the pairs first .. first + count - 1 pass the small exponents test
+static int screen(batchState *st, size_t first, size_t count) {
+
+    randomExponents(st, count);
+
+    // multiPower only reads the low RSA_BATCH_BITS, odd so no pair drops out
+    for (size_t k = 0; k < count; k++) {
+        st->exponents[k] |= 1;
+    }
+
+    multiPower(st, st->left, st->signatures, first, count);
+    multiPower(st, st->right, (const mpz_srcptr *)st->hashes, first, count);
+
+    publicPower(st->keyPair, st->left, st->left);
+
+    if (mpz_cmp(st->left, st->right) == 0) {
+        return 1;
+    }
+
+    // signatures of -h are valid too (rsaVerify), they multiply the product by -1
+    mpz_sub(st->left, st->keyPair->n, st->left);
+
+    return mpz_cmp(st->left, st->right) == 0;
+}
+
+// screen the range, and split it while it fails, failing is 1 when the range is
+// already known to fail (its sibling passed) and does not need screening
+static int checkRange(batchState *st, size_t first, size_t count, int failing) {
+
+    if (count == 0) {
+        return 1;
+    }
+
+    if (count <= BATCH_LEAF) {
+        int result = 1;
+
+        for (size_t i = first; i < first + count; i++) {
+            publicPower(st->keyPair, st->left, st->signatures[i]);
+            mpz_sub(st->right, st->keyPair->n, st->left);
+
+            // s^e = h or -h, the same as rsaVerify
+            st->valid[i] = mpz_cmp(st->left, st->hashes[i]) == 0 ||
+                           mpz_cmp(st->right, st->hashes[i]) == 0;
+            result &= st->valid[i];
+        }
+
+        return result;
+    }
+
+    if (!failing && screen(st, first, count)) {
+        for (size_t i = first; i < first + count; i++) {
+            st->valid[i] = 1;
+        }
+
+        return 1;
+    }
+
+    // if the left half passes the bad pairs are all on the right
+    size_t half = count / 2;
+    int leftValid = checkRange(st, first, half, 0);
+    int rightValid = checkRange(st, first + half, count - half, leftValid);
+
+    return leftValid && rightValid;
+}
+
+int rsaverifyBatch(const rsakeyPair *keyPair, const unsigned char *const *hashes,
+                   const size_t *hashLengths, const mpz_srcptr *signatures, size_t count,
+                   int *valid) {
+
+    if (count == 0) {
+        return 1;
+    }
+
+    // too few to screen, checked one by one without setting anything up
+    if (count <= BATCH_MIN) {
+        int result = 1;
+
+        for (size_t i = 0; i < count; i++) {
+            int ok = rsaVerify(keyPair, hashes[i], hashLengths[i], signatures[i]);
+
+            if (valid) {
+                valid[i] = ok;
+            }
+
+            result &= ok;
+        }
+
+        return result;
+    }
+
+    batchState *st = (batchState *)malloc(sizeof(batchState));
+    mpz_t *imported = (mpz_t *)malloc(count * sizeof(mpz_t));
+    // min(s, n - s) of every signature
+    mpz_t *folded = (mpz_t *)malloc(count * sizeof(mpz_t));
+    mpz_srcptr *hashList = (mpz_srcptr *)malloc(count * sizeof(mpz_srcptr));
+    mpz_srcptr *signatureList = (mpz_srcptr *)malloc(count * sizeof(mpz_srcptr));
+    uint64_t *exponents = (uint64_t *)malloc(count * sizeof(uint64_t));
+    // which of the pairs in screening order are valid, and where they came from
+    int *listValid = (int *)malloc(count * sizeof(int));
+    size_t *origin = (size_t *)malloc(count * sizeof(size_t));
+
+    if (!st || !imported || !folded || !hashList || !signatureList || !exponents || !listValid || !origin) {
+        fprintf(stderr, "Memory allocation failed\n");
+
+        free(st);
+        free(imported);
+        free(folded);
+        free(hashList);
+        free(signatureList);
+        free(exponents);
+        free(listValid);
+        free(origin);
+
+        return 0;
+    }
+
+    int result = 1;
+    size_t listed = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        mpz_init(imported[i]);
+        mpz_import(imported[i], hashLengths[i], 1, 1, 1, 0, hashes[i]);
+        mpz_init(folded[i]);
+
+        if (valid) {
+            valid[i] = 0;
+        }
+
+        // out of range can never verify, and would not be reduced like the rest
+        if (mpz_cmp(imported[i], keyPair->n) >= 0 || mpz_cmp(signatures[i], keyPair->n) >= 0) {
+            result = 0;
+            continue;
+        }
+
+        // s and n - s both verify (as h and -h), the screen only sees one of them
+        if (rsacanonicalSignature(keyPair, signatures[i])) {
+            mpz_set(folded[i], signatures[i]);
+        } else {
+            mpz_sub(folded[i], keyPair->n, signatures[i]);
+        }
+
+        hashList[listed] = imported[i];
+        signatureList[listed] = folded[i];
+        origin[listed] = i;
+        listed++;
+    }
+
+    st->keyPair = keyPair;
+    st->hashes = hashList;
+    st->signatures = signatureList;
+    st->exponents = exponents;
+    st->valid = listValid;
+
+    st->bucketCount = 0;
+    st->urandom = NULL;
+    st->urandomTried = 0;
+    st->fallback = 0;
+
+    mpz_init(st->running);
+    mpz_init(st->sum);
+    mpz_init(st->left);
+    mpz_init(st->right);
+
+    if (!checkRange(st, 0, listed, 0)) {
+        result = 0;
+    }
+
+    if (valid) {
+        for (size_t k = 0; k < listed; k++) {
+            valid[origin[k]] = listValid[k];
+        }
+    }
+
+    if (st->urandom) {
+        fclose(st->urandom);
+    }
+
+    if (st->fallback) {
+        gmp_randclear(st->random);
+    }
+
+    mpz_clear(st->running);
+    mpz_clear(st->sum);
+    mpz_clear(st->left);
+    mpz_clear(st->right);
+
+    for (size_t d = 0; d < st->bucketCount; d++) {
+        mpz_clear(st->buckets[d]);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        mpz_clear(imported[i]);
+        mpz_clear(folded[i]);
+    }
+
+    free(st);
+    free(imported);
+    free(folded);
+    free(hashList);
+    free(signatureList);
+    free(exponents);
+    free(listValid);
+    free(origin);
+
+    return result;
+}
@@ -0,0 +1,41 @@
+#ifndef RSA_BATCH_H
+#define RSA_BATCH_H
+
+#include <stddef.h>
+#include <gmp.h>
+#include "rsa.h"
+
+/*
+    Batch verification of many (hash, signature) pairs under one public key
+
+    Instead of s_i^e = h_i for every pair, a whole batch is screened at once with
+    random RSA_BATCH_BITS bit exponents r_i (small exponents test):
+
+        (prod s_i^r_i)^e = +-prod h_i^r_i  (mod n)
+
+    the two products share their squarings (bucket multi-exponentiation), so a
+    batch costs one exponentiation by e plus a few multiplications per pair.
+
+    Even without the r_i a passing batch means every hash was signed by the key
+    owner (screening, Bellare, Garay, Rabin), the exponents are there so that a
+    malformed signature of a signed hash also fails, except with probability about
+    2^-RSA_BATCH_BITS. A failing batch is split in halves with fresh exponents
+    until the bad pairs are isolated and checked one by one, so a valid signature
+    is never reported as bad.
+
+    The test cannot see a factor -1 (two n - s in a batch cancel out), so every
+    signature is folded to the smaller of s and n - s first (rsacanonicalSignature)
+    and s^e = -h counts as valid, the same as rsaVerify. What is left are
+    signatures off by one of the other square roots of 1, which only the key owner
+    can compute (they factor n), valid[] is then 1 where rsaVerify says 0.
+*/
+
+// the multiplications per pair grow with the bits, at 16 a batch costs about 4
+#define RSA_BATCH_BITS 16
+
+// 1 if every signature is valid, valid[i] (if not NULL) says which ones are
+int rsaverifyBatch(const rsakeyPair *keyPair, const unsigned char *const *hashes,
+                   const size_t *hashLengths, const mpz_srcptr *signatures, size_t count,
+                   int *valid);
+
+#endif
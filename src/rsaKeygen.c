@@ -91,7 +91,8 @@ int rsagenkeypairRandom(rsakeyPair *keyPair, unsigned int pBits,
         return EXIT_FAILURE;
     }
 
-    if (!mpz_invert(keyPair->d, keyPair->e, keyPair->phi)) {
+    if (!mpz_invert(keyPair->d, keyPair->e, keyPair->phi) ||
+        rsacomputeCrt(keyPair) != EXIT_SUCCESS) {
         fprintf(stderr, "Failed to calculate modular inverse\n");
 
         mpz_clear(pMinus1);
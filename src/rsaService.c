@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "rsaService.h"
+
+// https://man7.org/linux/man-pages/man7/pthreads.7.html
+
+static pthread_once_t sharedOnce = PTHREAD_ONCE_INIT;
+static rsaService sharedService;
+static int sharedStarted = 0;
+
+static void runRequest(rsaWorker *worker, rsaRequest *request) {
+
+    const uint8_t *digest = request->digest;
+    size_t digestLength = hashSize(request->algorithm);
+
+    // the message is whole in memory, hashData also takes the tree hash
+    if (!digest) {
+        if (hashData(request->algorithm, request->message, request->length,
+                     worker->digest) != EXIT_SUCCESS) {
+            request->result = request->type == RSA_REQUEST_SIGN ? EXIT_FAILURE : 0;
+
+            return;
+        }
+
+        digest = worker->digest;
+    }
+
+    if (request->type == RSA_REQUEST_SIGN) {
+        // an mpz_ptr is where the caller's mpz_t starts
+        request->result = rsaSign(request->keyPair, digest, digestLength,
+                                  (mpz_t *)request->signature);
+    } else {
+        request->result = rsaVerify(request->keyPair, digest, digestLength, request->signature);
+    }
+}
+
+static void complete(rsaRequest *request) {
+
+    rsaCompletion *completion = request->completion;
+
+    pthread_mutex_lock(&completion->lock);
+
+    request->next = NULL;
+
+    if (completion->tail) {
+        completion->tail->next = request;
+    } else {
+        completion->head = request;
+    }
+
+    completion->tail = request;
+
+    pthread_cond_signal(&completion->ready);
+    pthread_mutex_unlock(&completion->lock);
+}
+
+static void *workerMain(void *arg) {
+
+    rsaWorker *worker = (rsaWorker *)arg;
+    rsaService *service = worker->service;
+
+    for (;;) {
+        pthread_mutex_lock(&service->lock);
+
+        while (!service->head && !service->stopping) {
+            pthread_cond_wait(&service->ready, &service->lock);
+        }
+
+        // the queue is drained before stopping
+        rsaRequest *request = service->head;
+
+        if (!request) {
+            pthread_mutex_unlock(&service->lock);
+
+            break;
+        }
+
+        service->head = request->next;
+
+        if (!service->head) {
+            service->tail = NULL;
+        }
+
+        pthread_mutex_unlock(&service->lock);
+
+        runRequest(worker, request);
+        complete(request);
+    }
+
+    return NULL;
+}
+
+int rsaserviceInit(rsaService *service, size_t workers) {
+
+    if (workers == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = cpus > 0 ? (size_t)cpus : 1;
+    }
+
+    if (workers > RSA_SERVICE_MAX_WORKERS) {
+        workers = RSA_SERVICE_MAX_WORKERS;
+    }
+
+    pthread_mutex_init(&service->lock, NULL);
+    pthread_cond_init(&service->ready, NULL);
+
+    service->head = NULL;
+    service->tail = NULL;
+    service->stopping = 0;
+    service->workerCount = 0;
+
+    for (size_t i = 0; i < workers; i++) {
+        rsaWorker *worker = &service->workers[service->workerCount];
+
+        worker->service = service;
+
+        if (pthread_create(&worker->thread, NULL, workerMain, worker) != 0) {
+            fprintf(stderr, "Failed to start RSA worker, continuing with %zu\n",
+                    service->workerCount);
+            break;
+        }
+
+        service->workerCount++;
+    }
+
+    if (service->workerCount == 0) {
+        pthread_mutex_destroy(&service->lock);
+        pthread_cond_destroy(&service->ready);
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+void rsaserviceClear(rsaService *service) {
+
+    pthread_mutex_lock(&service->lock);
+    service->stopping = 1;
+    pthread_cond_broadcast(&service->ready);
+    pthread_mutex_unlock(&service->lock);
+
+    for (size_t i = 0; i < service->workerCount; i++) {
+        pthread_join(service->workers[i].thread, NULL);
+    }
+
+    service->workerCount = 0;
+
+    pthread_mutex_destroy(&service->lock);
+    pthread_cond_destroy(&service->ready);
+}
+
+static void startShared(void) {
+    sharedStarted = rsaserviceInit(&sharedService, 0) == EXIT_SUCCESS;
+}
+
+rsaService *rsaserviceShared(void) {
+
+    pthread_once(&sharedOnce, startShared);
+
+    return sharedStarted ? &sharedService : NULL;
+}
+
+void rsaserviceSubmit(rsaService *service, rsaRequest *request, rsaCompletion *completion) {
+
+    request->completion = completion;
+    request->next = NULL;
+
+    pthread_mutex_lock(&service->lock);
+
+    if (service->tail) {
+        service->tail->next = request;
+    } else {
+        service->head = request;
+    }
+
+    service->tail = request;
+
+    pthread_cond_signal(&service->ready);
+    pthread_mutex_unlock(&service->lock);
+}
+
+void rsacompletionInit(rsaCompletion *completion) {
+
+    pthread_mutex_init(&completion->lock, NULL);
+    pthread_cond_init(&completion->ready, NULL);
+
+    completion->head = NULL;
+    completion->tail = NULL;
+}
+
+void rsacompletionClear(rsaCompletion *completion) {
+    pthread_mutex_destroy(&completion->lock);
+    pthread_cond_destroy(&completion->ready);
+}
+
+rsaRequest *rsacompletionWait(rsaCompletion *completion) {
+
+    pthread_mutex_lock(&completion->lock);
+
+    while (!completion->head) {
+        pthread_cond_wait(&completion->ready, &completion->lock);
+    }
+
+    rsaRequest *request = completion->head;
+
+    completion->head = request->next;
+
+    if (!completion->head) {
+        completion->tail = NULL;
+    }
+
+    pthread_mutex_unlock(&completion->lock);
+
+    return request;
+}
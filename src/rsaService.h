@@ -0,0 +1,97 @@
+#ifndef RSA_SERVICE_H
+#define RSA_SERVICE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <gmp.h>
+#include "rsa.h"
+#include "hash.h"
+
+/*
+    RSA signing and verification service with a fixed pool of workers
+
+    Requests are queued with rsaserviceSubmit and handed back, finished, on the
+    completion queue named at submission, so a server thread can keep many of them
+    in flight and pick up the results in whatever order they finish. Each worker
+    has its own digest buffer, and the exponentiations run on the key's Montgomery
+    contexts with their scratch on the worker's stack (rsa.c), so a request does
+    not allocate once the signature mpz has grown to the key size (the tree hash
+    aside, it keeps its leaf digests on the heap).
+
+    Unlike threadPool.h (one blocking job at a time) the workers here only ever
+    run RSA requests, a long queue does not hold up the DES or hash paths.
+*/
+
+#define RSA_SERVICE_MAX_WORKERS 64
+
+typedef enum {
+    RSA_REQUEST_SIGN = 1,
+    RSA_REQUEST_VERIFY = 2
+} rsarequestType;
+
+typedef struct rsaCompletion rsaCompletion;
+
+typedef struct rsaRequest {
+    rsarequestType type;
+    const rsakeyPair *keyPair;
+    hashAlgorithm algorithm;
+    // the digest if the caller already has it, else the worker hashes message
+    const uint8_t *digest;
+    const uint8_t *message;
+    size_t length;
+    // sign: initialised by the caller and written by the worker, verify: read
+    mpz_ptr signature;
+    // set by the worker, EXIT_SUCCESS or EXIT_FAILURE for sign, 1 or 0 for verify
+    int result;
+    // for the caller, to find out what the request was about
+    void *context;
+    // owned by the queues
+    rsaCompletion *completion;
+    struct rsaRequest *next;
+} rsaRequest;
+
+struct rsaCompletion {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    rsaRequest *head;
+    rsaRequest *tail;
+};
+
+typedef struct rsaService rsaService;
+
+typedef struct {
+    rsaService *service;
+    pthread_t thread;
+    uint8_t digest[HASH_MAX_SIZE];
+} rsaWorker;
+
+struct rsaService {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    rsaRequest *head;
+    rsaRequest *tail;
+    int stopping;
+    size_t workerCount;
+    rsaWorker workers[RSA_SERVICE_MAX_WORKERS];
+};
+
+// start the workers, 0 means one per CPU, EXIT_FAILURE if none could be started
+int rsaserviceInit(rsaService *service, size_t workers);
+// finish every queued request, then stop the workers
+void rsaserviceClear(rsaService *service);
+
+// process wide service started on first use (one worker per CPU), NULL if it
+// could not start, the callers then do the work themselves
+rsaService *rsaserviceShared(void);
+
+// request and completion stay the caller's, and must not be touched until the
+// request comes back out of the completion queue
+void rsaserviceSubmit(rsaService *service, rsaRequest *request, rsaCompletion *completion);
+
+void rsacompletionInit(rsaCompletion *completion);
+void rsacompletionClear(rsaCompletion *completion);
+// the next finished request, blocks until there is one
+rsaRequest *rsacompletionWait(rsaCompletion *completion);
+
+#endif
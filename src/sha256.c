@@ -18,7 +18,9 @@
 //  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 //
 
+#include <string.h>
 #include "sha256.h"
+#include "sha256Constants.h"
 
 #ifndef _cbmc_
 #define __CPROVER_assume(...) do {} while(0)
@@ -30,7 +32,7 @@ extern "C" {
 
 #define FN_ static inline __attribute__((const))
 
-static const uint32_t K[64] = {
+const uint32_t sha256_k[64] = {
     0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
     0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
     0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
@@ -49,6 +51,11 @@ static const uint32_t K[64] = {
     0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
 };
 
+const uint32_t sha256_h0[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
 
 // -----------------------------------------------------------------------------
 FN_ uint8_t _shb(uint32_t x, uint32_t n)
@@ -114,72 +121,217 @@ FN_ uint32_t _G1(uint32_t x)
 
 
 // -----------------------------------------------------------------------------
-FN_ uint32_t _word(uint8_t *c)
+FN_ uint32_t _word(const uint8_t *c)
 {
     return (_shw(c[0], 24) | _shw(c[1], 16) | _shw(c[2], 8) | (c[3]));
 } // _word
 
 
 // -----------------------------------------------------------------------------
-static void _addbits(sha256_context *ctx, uint32_t n)
+static void _addbits(sha256_context *ctx, uint64_t n)
 {
     __CPROVER_assume(__CPROVER_DYNAMIC_OBJECT(ctx));
 
-    if (ctx->bits[0] > (0xffffffff - n)) {
-        ctx->bits[1] = (ctx->bits[1] + 1) & 0xFFFFFFFF;
-    }
-    ctx->bits[0] = (ctx->bits[0] + n) & 0xFFFFFFFF;
+    uint64_t bits = ((uint64_t)ctx->bits[1] << 32) | ctx->bits[0];
+
+    bits += n;
+    ctx->bits[0] = (uint32_t)bits;
+    ctx->bits[1] = (uint32_t)(bits >> 32);
 } // _addbits
 
 
 // -----------------------------------------------------------------------------
-static void _hash(sha256_context *ctx)
+// compress `blocks` consecutive 64 byte blocks of data into hash
+// the message schedule only ever looks 16 words back, so it rolls in W[16]
+static void _hash(uint32_t *hash, const uint8_t *data, size_t blocks)
 {
-    __CPROVER_assume(__CPROVER_DYNAMIC_OBJECT(ctx));
+    __CPROVER_assume(__CPROVER_DYNAMIC_OBJECT(hash));
 
     register uint32_t a, b, c, d, e, f, g, h;
     uint32_t t[2];
+    uint32_t W[16];
+
+    for (; blocks > 0; blocks--, data += 64) {
+        a = hash[0];
+        b = hash[1];
+        c = hash[2];
+        d = hash[3];
+        e = hash[4];
+        f = hash[5];
+        g = hash[6];
+        h = hash[7];
+
+        for (uint32_t i = 0; i < 64; i++) {
+            if (i < 16) {
+                W[i] = _word(&data[_shw(i, 2)]);
+            } else {
+                W[i & 15] += _G1(W[(i - 2) & 15]) + W[(i - 7) & 15] +
+                             _G0(W[(i - 15) & 15]);
+            }
 
-    a = ctx->hash[0];
-    b = ctx->hash[1];
-    c = ctx->hash[2];
-    d = ctx->hash[3];
-    e = ctx->hash[4];
-    f = ctx->hash[5];
-    g = ctx->hash[6];
-    h = ctx->hash[7];
-
-    for (uint32_t i = 0; i < 64; i++) {
-        if (i < 16) {
-            ctx->W[i] = _word(&ctx->buf[_shw(i, 2)]);
-        } else {
-            ctx->W[i] = _G1(ctx->W[i - 2])  + ctx->W[i - 7] +
-                        _G0(ctx->W[i - 15]) + ctx->W[i - 16];
+            t[0] = h + _S1(e) + _Ch(e, f, g) + sha256_k[i] + W[i & 15];
+            t[1] = _S0(a) + _Ma(a, b, c);
+            h = g;
+            g = f;
+            f = e;
+            e = d + t[0];
+            d = c;
+            c = b;
+            b = a;
+            a = t[0] + t[1];
         }
 
-        t[0] = h + _S1(e) + _Ch(e, f, g) + K[i] + ctx->W[i];
-        t[1] = _S0(a) + _Ma(a, b, c);
-        h = g;
-        g = f;
-        f = e;
-        e = d + t[0];
-        d = c;
-        c = b;
-        b = a;
-        a = t[0] + t[1];
+        hash[0] += a;
+        hash[1] += b;
+        hash[2] += c;
+        hash[3] += d;
+        hash[4] += e;
+        hash[5] += f;
+        hash[6] += g;
+        hash[7] += h;
     }
-
-    ctx->hash[0] += a;
-    ctx->hash[1] += b;
-    ctx->hash[2] += c;
-    ctx->hash[3] += d;
-    ctx->hash[4] += e;
-    ctx->hash[5] += f;
-    ctx->hash[6] += g;
-    ctx->hash[7] += h;
 } // _hash
 
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+
+// -----------------------------------------------------------------------------
+// same as _hash with the SHA extensions (Intel SHA-NI / AMD Zen): sha256rnds2
+// does two rounds, sha256msg1/msg2 four words of the message schedule
+// the state lives as ABEF / CDGH halves, which is what sha256rnds2 works on
+#define SHANI_ static inline __attribute__((always_inline, target("sha,sse4.1")))
+
+SHANI_ void _shani_load(const uint32_t *hash, __m128i *state0, __m128i *state1)
+{
+    __m128i tmp = _mm_loadu_si128((const __m128i *)&hash[0]);
+
+    *state1 = _mm_loadu_si128((const __m128i *)&hash[4]);
+
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);                 // CDAB
+    *state1 = _mm_shuffle_epi32(*state1, 0x1B);         // EFGH
+    *state0 = _mm_alignr_epi8(tmp, *state1, 8);         // ABEF
+    *state1 = _mm_blend_epi16(*state1, tmp, 0xF0);      // CDGH
+} // _shani_load
+
+
+SHANI_ void _shani_store(uint32_t *hash, __m128i state0, __m128i state1)
+{
+    __m128i tmp = _mm_shuffle_epi32(state0, 0x1B);      // FEBA
+
+    state1 = _mm_shuffle_epi32(state1, 0xB1);           // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);        // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);           // HGFE
+
+    _mm_storeu_si128((__m128i *)&hash[0], state0);
+    _mm_storeu_si128((__m128i *)&hash[4], state1);
+} // _shani_store
+
+
+SHANI_ void _shani_block(__m128i *state0, __m128i *state1, const uint8_t *data)
+{
+    const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i abef = *state0;
+    __m128i cdgh = *state1;
+    __m128i tmp, msg, w[4];
+
+    for (int i = 0; i < 4; i++) {
+        w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)&data[16 * i]), MASK);
+    }
+
+    #pragma GCC unroll 16
+    for (int i = 0; i < 16; i++) {
+        msg = _mm_add_epi32(w[i & 3], _mm_loadu_si128((const __m128i *)&sha256_k[4 * i]));
+
+        // words 4i+16 .. 4i+19 replace 4i .. 4i+3, which are not needed anymore
+        if (i < 12) {
+            tmp = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+            tmp = _mm_add_epi32(tmp, _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+            w[i & 3] = _mm_sha256msg2_epu32(tmp, w[(i + 3) & 3]);
+        }
+
+        *state1 = _mm_sha256rnds2_epu32(*state1, *state0, msg);
+        msg = _mm_shuffle_epi32(msg, 0x0E);
+        *state0 = _mm_sha256rnds2_epu32(*state0, *state1, msg);
+    }
+
+    *state0 = _mm_add_epi32(*state0, abef);
+    *state1 = _mm_add_epi32(*state1, cdgh);
+} // _shani_block
+
+
+__attribute__((target("sha,sse4.1")))
+static void _hash_shani(uint32_t *hash, const uint8_t *data, size_t blocks)
+{
+    __m128i state0, state1;
+
+    _shani_load(hash, &state0, &state1);
+
+    for (; blocks > 0; blocks--, data += 64) {
+        _shani_block(&state0, &state1, data);
+    }
+
+    _shani_store(hash, state0, state1);
+} // _hash_shani
+
+
+// -----------------------------------------------------------------------------
+// two independent messages side by side, sha256rnds2 has a few cycles of latency
+// and one message alone leaves the unit waiting on its own previous rounds
+__attribute__((target("sha,sse4.1")))
+static void _hash_shani2(uint32_t *hash0, const uint8_t *data0,
+                         uint32_t *hash1, const uint8_t *data1, size_t blocks)
+{
+    __m128i a0, a1, b0, b1;
+
+    _shani_load(hash0, &a0, &a1);
+    _shani_load(hash1, &b0, &b1);
+
+    for (; blocks > 0; blocks--, data0 += 64, data1 += 64) {
+        _shani_block(&a0, &a1, data0);
+        _shani_block(&b0, &b1, data1);
+    }
+
+    _shani_store(hash0, a0, a1);
+    _shani_store(hash1, b0, b1);
+} // _hash_shani2
+#endif
+
+
+// -----------------------------------------------------------------------------
+static void _hash2(uint32_t *hash0, const uint8_t *data0,
+                   uint32_t *hash1, const uint8_t *data1, size_t blocks)
+{
+    _hash(hash0, data0, blocks);
+    _hash(hash1, data1, blocks);
+} // _hash2
+
+
+// -----------------------------------------------------------------------------
+// compression functions in use, picked once at startup
+static void (*_compress)(uint32_t *hash, const uint8_t *data, size_t blocks) = _hash;
+static void (*_compress2)(uint32_t *hash0, const uint8_t *data0,
+                          uint32_t *hash1, const uint8_t *data1, size_t blocks) = _hash2;
+
+__attribute__((constructor))
+static void _select_compress(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+
+    // SSE4.1 is CPUID.1:ECX bit 19, SSSE3 bit 9, SHA is CPUID.(7,0):EBX bit 29
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) &&
+        (ecx & (1u << 19)) && (ecx & (1u << 9)) &&
+        __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) &&
+        (ebx & (1u << 29))) {
+        _compress = _hash_shani;
+        _compress2 = _hash_shani2;
+    }
+#endif
+} // _select_compress
+
+
 // -----------------------------------------------------------------------------
 void sha256_init(sha256_context *ctx)
 {
@@ -205,14 +357,42 @@ void sha256_hash(sha256_context *ctx, const void *data, size_t len)
     if ((ctx != NULL) && (bytes != NULL) && (ctx->len < sizeof(ctx->buf))) {
         __CPROVER_assume(__CPROVER_DYNAMIC_OBJECT(bytes));
         __CPROVER_assume(__CPROVER_DYNAMIC_OBJECT(ctx));
-        for (size_t i = 0; i < len; i++) {
-            ctx->buf[ctx->len++] = bytes[i];
-            if (ctx->len == sizeof(ctx->buf)) {
-                _hash(ctx);
-                _addbits(ctx, sizeof(ctx->buf) * 8);
-                ctx->len = 0;
+
+        // top up a partially filled buffer first
+        if (ctx->len > 0) {
+            size_t n = sizeof(ctx->buf) - ctx->len;
+
+            if (n > len) {
+                n = len;
+            }
+
+            memcpy(&ctx->buf[ctx->len], bytes, n);
+            ctx->len += (uint32_t)n;
+            bytes += n;
+            len -= n;
+
+            if (ctx->len < sizeof(ctx->buf)) {
+                return;
             }
+
+            _compress(ctx->hash, ctx->buf, 1);
+            _addbits(ctx, sizeof(ctx->buf) * 8);
+            ctx->len = 0;
         }
+
+        // whole blocks straight from the caller's buffer
+        size_t blocks = len / sizeof(ctx->buf);
+
+        if (blocks > 0) {
+            _compress(ctx->hash, bytes, blocks);
+            _addbits(ctx, (uint64_t)blocks * sizeof(ctx->buf) * 8);
+            bytes += blocks * sizeof(ctx->buf);
+            len -= blocks * sizeof(ctx->buf);
+        }
+
+        // and keep the tail for later
+        memcpy(ctx->buf, bytes, len);
+        ctx->len = (uint32_t)len;
     }
 } // sha256_hash
 
@@ -230,7 +410,7 @@ void sha256_done(sha256_context *ctx, uint8_t *hash)
         }
 
         if (ctx->len > 55) {
-            _hash(ctx);
+            _compress(ctx->hash, ctx->buf, 1);
             for (j = 0; j < sizeof(ctx->buf); j++) {
                 ctx->buf[j] = 0x00;
             }
@@ -245,7 +425,7 @@ void sha256_done(sha256_context *ctx, uint8_t *hash)
         ctx->buf[58] = _shb(ctx->bits[1],  8);
         ctx->buf[57] = _shb(ctx->bits[1], 16);
         ctx->buf[56] = _shb(ctx->bits[1], 24);
-        _hash(ctx);
+        _compress(ctx->hash, ctx->buf, 1);
 
         if (hash != NULL) {
             for (i = 0, j = 24; i < 4; i++, j -= 8) {
@@ -274,6 +454,162 @@ void sha256(const void *data, size_t len, uint8_t *hash)
 } // sha256
 
 
+// -----------------------------------------------------------------------------
+// lay out a message of at most SHA256_SHORT_MAX bytes with its padding and
+// length in buf, returns the number of blocks. prefix is the length in bits of
+// whatever was hashed before (a sha256_midstate), 0 for a plain message
+static size_t _pad_short(uint8_t *buf, const void *data, size_t len, uint64_t prefix)
+{
+    size_t blocks = (len > 55) ? 2 : 1;
+    uint64_t bits = prefix + (uint64_t)len * 8;
+
+    memset(buf, 0, blocks * 64);
+
+    if (len > 0) {
+        memcpy(buf, data, len);
+    }
+
+    buf[len] = 0x80;
+
+    for (uint32_t i = 0; i < 8; i++) {
+        buf[blocks * 64 - 1 - i] = (uint8_t)(bits >> (8 * i));
+    }
+
+    return blocks;
+} // _pad_short
+
+
+// -----------------------------------------------------------------------------
+static void _put_hash(uint8_t *hash, const uint32_t *state)
+{
+    for (uint32_t i = 0; i < 8; i++) {
+        uint32_t w = __builtin_bswap32(state[i]);
+
+        memcpy(&hash[4 * i], &w, sizeof(w));
+    }
+} // _put_hash
+
+
+// -----------------------------------------------------------------------------
+// one-shot for messages of one or two blocks: the padded message is laid out
+// once on the stack and compressed straight from the initial state, without the
+// context buffering or the branches of sha256_done
+void sha256_short(const void *data, size_t len, uint8_t *hash)
+{
+    if (len > SHA256_SHORT_MAX) {
+        sha256(data, len, hash);
+        return;
+    }
+
+    uint8_t buf[128];
+    uint32_t state[8];
+    size_t blocks = _pad_short(buf, data, len, 0);
+
+    memcpy(state, sha256_h0, sizeof(state));
+    _compress(state, buf, blocks);
+    _put_hash(hash, state);
+} // sha256_short
+
+
+// -----------------------------------------------------------------------------
+// messages are taken two at a time through _compress2, so the SHA-NI units work
+// on both at once
+void sha256_short_batch(const void *const *data, const size_t *len, uint8_t *hash,
+                        size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 1 < count; i += 2) {
+        if (len[i] > SHA256_SHORT_MAX || len[i + 1] > SHA256_SHORT_MAX) {
+            sha256_short(data[i], len[i], &hash[i * SHA256_SIZE_BYTES]);
+            sha256_short(data[i + 1], len[i + 1], &hash[(i + 1) * SHA256_SIZE_BYTES]);
+            continue;
+        }
+
+        uint8_t buf[2][128];
+        uint32_t state[2][8];
+        size_t blocks0 = _pad_short(buf[0], data[i], len[i], 0);
+        size_t blocks1 = _pad_short(buf[1], data[i + 1], len[i + 1], 0);
+        size_t both = (blocks0 < blocks1) ? blocks0 : blocks1;
+
+        memcpy(state[0], sha256_h0, sizeof(state[0]));
+        memcpy(state[1], sha256_h0, sizeof(state[1]));
+
+        _compress2(state[0], buf[0], state[1], buf[1], both);
+
+        // a one block message next to a two block one
+        if (blocks0 > both) {
+            _compress(state[0], &buf[0][64], 1);
+        } else if (blocks1 > both) {
+            _compress(state[1], &buf[1][64], 1);
+        }
+
+        _put_hash(&hash[i * SHA256_SIZE_BYTES], state[0]);
+        _put_hash(&hash[(i + 1) * SHA256_SIZE_BYTES], state[1]);
+    }
+
+    if (i < count) {
+        sha256_short(data[i], len[i], &hash[i * SHA256_SIZE_BYTES]);
+    }
+} // sha256_short_batch
+
+
+// -----------------------------------------------------------------------------
+int sha256_prefix(sha256_midstate *mid, const void *prefix, size_t len)
+{
+    // zero filling a partial block would not keep its length, "tag" and
+    // "tag\0" would give the same state, so only whole blocks are taken
+    if ((mid == NULL) || (len % 64 != 0)) {
+        return -1;
+    }
+
+    memcpy(mid->hash, sha256_h0, sizeof(mid->hash));
+
+    if (len > 0) {
+        _compress(mid->hash, (const uint8_t *)prefix, len / 64);
+    }
+
+    mid->bits = (uint64_t)len * 8;
+
+    return 0;
+} // sha256_prefix
+
+
+// -----------------------------------------------------------------------------
+void sha256_resume(sha256_context *ctx, const sha256_midstate *mid)
+{
+    if ((ctx != NULL) && (mid != NULL)) {
+        memcpy(ctx->hash, mid->hash, sizeof(ctx->hash));
+        ctx->bits[0] = (uint32_t)mid->bits;
+        ctx->bits[1] = (uint32_t)(mid->bits >> 32);
+        ctx->len = 0;
+    }
+} // sha256_resume
+
+
+// -----------------------------------------------------------------------------
+void sha256_prefixed(const sha256_midstate *mid, const void *data, size_t len, uint8_t *hash)
+{
+    uint32_t state[8];
+
+    if (len > SHA256_SHORT_MAX) {
+        sha256_context ctx;
+
+        sha256_resume(&ctx, mid);
+        sha256_hash(&ctx, data, len);
+        sha256_done(&ctx, hash);
+        return;
+    }
+
+    uint8_t buf[128];
+    size_t blocks = _pad_short(buf, data, len, mid->bits);
+
+    memcpy(state, mid->hash, sizeof(state));
+    _compress(state, buf, blocks);
+    _put_hash(hash, state);
+} // sha256_prefixed
+
+
 #if 0
 #pragma mark - Self Test
 #endif
@@ -25,6 +25,9 @@
 
 #define SHA256_SIZE_BYTES    (32)
 
+// longest message that still pads into two blocks
+#define SHA256_SHORT_MAX     (119)
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -36,15 +39,37 @@ typedef struct {
     uint32_t bits[2];
     uint32_t len;
     uint32_t rfu__;
-    uint32_t W[64];
 } sha256_context;
 
+// state after a fixed prefix of whole blocks (HMAC pads, an election ID encoded
+// into a block, ...), so no buffer has to be kept
+typedef struct {
+    uint32_t hash[8];
+    uint64_t bits;
+} sha256_midstate;
+
 void sha256_init(sha256_context *ctx);
 void sha256_hash(sha256_context *ctx, const void *data, size_t len);
 void sha256_done(sha256_context *ctx, uint8_t *hash);
 
 void sha256(const void *data, size_t len, uint8_t *hash);
 
+// same result as sha256, without a context, for up to SHA256_SHORT_MAX bytes
+// (longer messages go through sha256)
+void sha256_short(const void *data, size_t len, uint8_t *hash);
+// sha256_short over count messages, hash[i * SHA256_SIZE_BYTES] is data[i]'s digest
+void sha256_short_batch(const void *const *data, const size_t *len, uint8_t *hash,
+                        size_t count);
+
+// hash the prefix once, then every message hashed from mid is
+// SHA-256(prefix || message). len must be a multiple of 64, else -1 and mid is
+// left alone (pad and length-encode a shorter tag before calling)
+int sha256_prefix(sha256_midstate *mid, const void *prefix, size_t len);
+// start ctx from mid, as if sha256_init and the prefix had been hashed into it
+void sha256_resume(sha256_context *ctx, const sha256_midstate *mid);
+// one-shot from mid, as cheap as sha256_short for messages up to SHA256_SHORT_MAX
+void sha256_prefixed(const sha256_midstate *mid, const void *data, size_t len, uint8_t *hash);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,12 @@
+#ifndef SHA256_CONSTANTS_H
+#define SHA256_CONSTANTS_H
+
+#include <stdint.h>
+
+// round constants and initial hash, defined once in sha256.c and shared with the
+// multi-buffer code (sha256Multi.c), not part of the sha256.h interface
+
+extern const uint32_t sha256_k[64];
+extern const uint32_t sha256_h0[8];
+
+#endif
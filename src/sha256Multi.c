@@ -0,0 +1,171 @@
+#include <string.h>
+#include "sha256Multi.h"
+#include "sha256Constants.h"
+
+// one 32 bit word of every lane
+typedef uint32_t shv __attribute__((vector_size(4 * SHA256_LANES)));
+
+// a group costs the same however many lanes are in use, below half full hashing
+// the messages one by one (SHA-NI where there is one) is faster
+#define MULTI_MIN_LANES 8
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static inline uint32_t loadWord(const uint8_t *bytes) {
+    return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) |
+           ((uint32_t)bytes[2] << 8) | (uint32_t)bytes[3];
+}
+
+// one block for every lane, blocks[l] is 64 bytes, lanes whose active word is 0
+// keep their state
+__attribute__((target_clones("avx512f", "avx2", "default")))
+static void compressLanes(shv *state, const uint8_t *const *blocks, const shv *active) {
+
+    // only the last 16 words of the schedule are ever needed
+    shv W[16];
+
+    for (int j = 0; j < 16; j++) {
+        for (int l = 0; l < SHA256_LANES; l++) {
+            W[j][l] = loadWord(blocks[l] + 4 * j);
+        }
+    }
+
+    shv a = state[0], b = state[1], c = state[2], d = state[3];
+    shv e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int i = 0; i < 64; i++) {
+        if (i >= 16) {
+            shv w2 = W[(i - 2) & 15], w15 = W[(i - 15) & 15];
+
+            W[i & 15] += (ROTR(w2, 17) ^ ROTR(w2, 19) ^ (w2 >> 10)) + W[(i - 7) & 15] +
+                         (ROTR(w15, 7) ^ ROTR(w15, 18) ^ (w15 >> 3));
+        }
+
+        shv t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) +
+                 sha256_k[i] + W[i & 15];
+        shv t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state[0] += a & *active;
+    state[1] += b & *active;
+    state[2] += c & *active;
+    state[3] += d & *active;
+    state[4] += e & *active;
+    state[5] += f & *active;
+    state[6] += g & *active;
+    state[7] += h & *active;
+}
+
+// up to SHA256_LANES messages, one per lane, all starting from mid (or from the
+// initial hash when mid is NULL)
+static void hashGroup(const sha256_midstate *mid, const uint8_t *const *messages,
+                      const size_t *lengths, uint8_t *digests, size_t count) {
+
+    // the last one or two blocks of every message, with the padding and length
+    static const uint8_t zeroBlock[64];
+    uint8_t tails[SHA256_LANES][128];
+    size_t fullBlocks[SHA256_LANES];
+    size_t totalBlocks[SHA256_LANES];
+    size_t maxBlocks = 0;
+
+    for (size_t l = 0; l < count; l++) {
+        size_t length = lengths[l];
+        size_t rest = length % 64;
+
+        fullBlocks[l] = length / 64;
+        // 0x80 and the 8 byte length must fit after the rest, else one more block
+        totalBlocks[l] = fullBlocks[l] + (rest + 9 > 64 ? 2 : 1);
+
+        size_t tailLength = (totalBlocks[l] - fullBlocks[l]) * 64;
+        uint64_t bits = (mid ? mid->bits : 0) + (uint64_t)length * 8;
+
+        memset(tails[l], 0, tailLength);
+        if (rest > 0) {
+            memcpy(tails[l], messages[l] + fullBlocks[l] * 64, rest);
+        }
+
+        tails[l][rest] = 0x80;
+
+        for (int k = 0; k < 8; k++) {
+            tails[l][tailLength - 1 - k] = (uint8_t)(bits >> (8 * k));
+        }
+
+        if (totalBlocks[l] > maxBlocks) {
+            maxBlocks = totalBlocks[l];
+        }
+    }
+
+    shv state[8];
+
+    for (int i = 0; i < 8; i++) {
+        for (int l = 0; l < SHA256_LANES; l++) {
+            state[i][l] = mid ? mid->hash[i] : sha256_h0[i];
+        }
+    }
+
+    for (size_t b = 0; b < maxBlocks; b++) {
+        const uint8_t *blocks[SHA256_LANES];
+        shv active;
+
+        for (size_t l = 0; l < SHA256_LANES; l++) {
+            if (l >= count || b >= totalBlocks[l]) {
+                blocks[l] = zeroBlock;
+                active[l] = 0;
+            } else {
+                blocks[l] = b < fullBlocks[l] ? messages[l] + b * 64
+                                              : tails[l] + (b - fullBlocks[l]) * 64;
+                active[l] = 0xffffffff;
+            }
+        }
+
+        compressLanes(state, blocks, &active);
+    }
+
+    for (size_t l = 0; l < count; l++) {
+        for (int i = 0; i < 8; i++) {
+            uint8_t *out = digests + l * SHA256_SIZE_BYTES + 4 * i;
+
+            out[0] = (uint8_t)(state[i][l] >> 24);
+            out[1] = (uint8_t)(state[i][l] >> 16);
+            out[2] = (uint8_t)(state[i][l] >> 8);
+            out[3] = (uint8_t)state[i][l];
+        }
+    }
+}
+
+void sha256multiPrefixed(const sha256_midstate *mid, const uint8_t *const *messages,
+                         const size_t *lengths, uint8_t *digests, size_t count) {
+
+    while (count > 0) {
+        size_t lanes = count < SHA256_LANES ? count : SHA256_LANES;
+
+        if (lanes >= MULTI_MIN_LANES) {
+            hashGroup(mid, messages, lengths, digests, lanes);
+        } else if (mid) {
+            for (size_t l = 0; l < lanes; l++) {
+                sha256_prefixed(mid, messages[l], lengths[l], digests + l * SHA256_SIZE_BYTES);
+            }
+        } else {
+            sha256_short_batch((const void *const *)messages, lengths, digests, lanes);
+        }
+
+        messages += lanes;
+        lengths += lanes;
+        digests += lanes * SHA256_SIZE_BYTES;
+        count -= lanes;
+    }
+}
+
+void sha256Multi(const uint8_t *const *messages, const size_t *lengths, uint8_t *digests,
+                 size_t count) {
+    sha256multiPrefixed(NULL, messages, lengths, digests, count);
+}
@@ -0,0 +1,30 @@
+#ifndef SHA256_MULTI_H
+#define SHA256_MULTI_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sha256.h"
+
+/*
+    Multi-buffer SHA-256, for batches of short independent messages (ballots)
+
+    One message per lane: word j of every lane's block sits in one vector, so the
+    64 rounds run on 16 messages at once. A vector is 16 x 32 bits, the compiler
+    lowers it to one AVX-512 register, two AVX2 or four SSE ones, and the clone
+    for the CPU is picked when the program loads (like desBitslice.c).
+
+    Messages may have different lengths, a lane that has run out of blocks just
+    stops updating its state until the longest message of the group is done.
+*/
+
+#define SHA256_LANES 16
+
+// digest of messages[i] (lengths[i] bytes) goes to digests + i * SHA256_SIZE_BYTES
+void sha256Multi(const uint8_t *const *messages, const size_t *lengths, uint8_t *digests,
+                 size_t count);
+
+// same with every message hashed after the prefix of mid (see sha256_prefix)
+void sha256multiPrefixed(const sha256_midstate *mid, const uint8_t *const *messages,
+                         const size_t *lengths, uint8_t *digests, size_t count);
+
+#endif
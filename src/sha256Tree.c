@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sha256Tree.h"
+#include "sha256Multi.h"
+#include "threadPool.h"
+
+typedef struct {
+    const uint8_t *data;
+    size_t length;
+    size_t leafSize;
+    uint8_t *digests;
+} treeJob;
+
+void sha256treeLeaf(const uint8_t *data, size_t length, uint8_t *digest) {
+
+    const uint8_t tag = SHA256_TREE_LEAF;
+    sha256_context ctx;
+
+    sha256_init(&ctx);
+    sha256_hash(&ctx, &tag, 1);
+    sha256_hash(&ctx, data, length);
+    sha256_done(&ctx, digest);
+}
+
+static void treeLeaf(void *arg, size_t leaf) {
+
+    const treeJob *job = (const treeJob *)arg;
+    size_t start = leaf * job->leafSize;
+    size_t length = job->length - start < job->leafSize ? job->length - start : job->leafSize;
+
+    sha256treeLeaf(job->data + start, length, job->digests + leaf * SHA256_SIZE_BYTES);
+}
+
+void sha256treeLeaves(const uint8_t *data, size_t length, size_t leafSize, uint8_t *digests) {
+
+    if (leafSize == 0) {
+        leafSize = SHA256_TREE_LEAF_SIZE;
+    }
+
+    size_t leaves = (length + leafSize - 1) / leafSize;
+    treeJob job = { data, length, leafSize, digests };
+
+    threadpoolFor(leaves, treeLeaf, &job);
+}
+
+void sha256treeRoot(uint8_t *leafDigests, size_t leaves, uint8_t *root) {
+
+    // 0x01 || left || right for every pair of a level
+    uint8_t *nodes = NULL;
+    const uint8_t **messages = NULL;
+    size_t *lengths = NULL;
+
+    if (leaves > 1) {
+        nodes = (uint8_t *)malloc((leaves / 2) * (1 + 2 * SHA256_SIZE_BYTES));
+        messages = (const uint8_t **)malloc((leaves / 2) * sizeof(uint8_t *));
+        lengths = (size_t *)malloc((leaves / 2) * sizeof(size_t));
+    }
+
+    while (leaves > 1) {
+        size_t pairs = leaves / 2;
+
+        if (!nodes || !messages || !lengths) {
+            // still the same digest, one node at a time
+            for (size_t i = 0; i < pairs; i++) {
+                uint8_t node[1 + 2 * SHA256_SIZE_BYTES];
+
+                node[0] = SHA256_TREE_NODE;
+                memcpy(node + 1, leafDigests + 2 * i * SHA256_SIZE_BYTES, 2 * SHA256_SIZE_BYTES);
+                sha256(node, sizeof(node), leafDigests + i * SHA256_SIZE_BYTES);
+            }
+        } else {
+            // a level is many short independent messages, the multi-buffer case
+            for (size_t i = 0; i < pairs; i++) {
+                uint8_t *node = nodes + i * (1 + 2 * SHA256_SIZE_BYTES);
+
+                node[0] = SHA256_TREE_NODE;
+                memcpy(node + 1, leafDigests + 2 * i * SHA256_SIZE_BYTES, 2 * SHA256_SIZE_BYTES);
+
+                messages[i] = node;
+                lengths[i] = 1 + 2 * SHA256_SIZE_BYTES;
+            }
+
+            sha256Multi(messages, lengths, leafDigests, pairs);
+        }
+
+        // the odd one out moves up as it is
+        if (leaves % 2) {
+            memmove(leafDigests + pairs * SHA256_SIZE_BYTES,
+                    leafDigests + (leaves - 1) * SHA256_SIZE_BYTES, SHA256_SIZE_BYTES);
+        }
+
+        leaves = pairs + leaves % 2;
+    }
+
+    memcpy(root, leafDigests, SHA256_SIZE_BYTES);
+
+    free(nodes);
+    free(messages);
+    free(lengths);
+}
+
+int sha256Tree(const uint8_t *data, size_t length, size_t leafSize, uint8_t *digest) {
+
+    if (leafSize == 0) {
+        leafSize = SHA256_TREE_LEAF_SIZE;
+    }
+
+    size_t leaves = length == 0 ? 1 : (length + leafSize - 1) / leafSize;
+    uint8_t *digests = (uint8_t *)malloc(leaves * SHA256_SIZE_BYTES);
+
+    if (!digests) {
+        fprintf(stderr, "Memory allocation failed\n");
+
+        return EXIT_FAILURE;
+    }
+
+    if (length == 0) {
+        sha256treeLeaf(data, 0, digests);
+    } else {
+        sha256treeLeaves(data, length, leafSize, digests);
+    }
+
+    sha256treeRoot(digests, leaves, digest);
+
+    free(digests);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,40 @@
+#ifndef SHA256_TREE_H
+#define SHA256_TREE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sha256.h"
+
+/*
+    Tree hash for large inputs (ballot archives, image batches)
+
+    The input is cut in fixed size leaves that are hashed independently, in
+    parallel over the worker pool (threadPool.c), and the leaf digests are then
+    combined pairwise up to a single root:
+
+        leaf = SHA-256(0x00 || leaf data)
+        node = SHA-256(0x01 || left || right)
+
+    an odd node at the end of a level moves up unchanged. The domain bytes keep a
+    leaf from ever passing for a node, and a tree digest from ever being the plain
+    SHA-256 of the same input (even with one leaf), so the two cannot be mixed up.
+    The digest depends on the leaf size, both sides have to agree on it.
+*/
+
+#define SHA256_TREE_LEAF_SIZE (1024 * 1024)
+
+#define SHA256_TREE_LEAF 0x00
+#define SHA256_TREE_NODE 0x01
+
+// leafSize 0 means SHA256_TREE_LEAF_SIZE, an empty input is one empty leaf
+int sha256Tree(const uint8_t *data, size_t length, size_t leafSize, uint8_t *digest);
+
+// the two halves, for inputs that are not in memory at once
+void sha256treeLeaf(const uint8_t *data, size_t length, uint8_t *digest);
+// the leaves of data in parallel, the last one may be short, digests holds
+// SHA256_SIZE_BYTES per leaf, leafSize 0 means SHA256_TREE_LEAF_SIZE
+void sha256treeLeaves(const uint8_t *data, size_t length, size_t leafSize, uint8_t *digests);
+// leafDigests holds leaves * SHA256_SIZE_BYTES bytes and is overwritten
+void sha256treeRoot(uint8_t *leafDigests, size_t leaves, uint8_t *root);
+
+#endif
@@ -0,0 +1,301 @@
+//
+//  SHA-512 and SHA-512/256, laid out like sha256.c
+//
+
+#include <string.h>
+#include "sha512.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FN_ static inline __attribute__((const))
+
+static const uint64_t K[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+    0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+    0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+    0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+    0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+    0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+    0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+    0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+    0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+    0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+    0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+    0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+
+// -----------------------------------------------------------------------------
+FN_ uint64_t _r(uint64_t x, uint8_t n)
+{
+    return ((x >> n) | (x << (64 - n)));
+} // _r
+
+
+// -----------------------------------------------------------------------------
+FN_ uint64_t _Ch(uint64_t x, uint64_t y, uint64_t z)
+{
+    return ((x & y) ^ ((~x) & z));
+} // _Ch
+
+
+// -----------------------------------------------------------------------------
+FN_ uint64_t _Ma(uint64_t x, uint64_t y, uint64_t z)
+{
+    return ((x & y) ^ (x & z) ^ (y & z));
+} // _Ma
+
+
+// -----------------------------------------------------------------------------
+FN_ uint64_t _S0(uint64_t x)
+{
+    return (_r(x, 28) ^ _r(x, 34) ^ _r(x, 39));
+} // _S0
+
+
+// -----------------------------------------------------------------------------
+FN_ uint64_t _S1(uint64_t x)
+{
+    return (_r(x, 14) ^ _r(x, 18) ^ _r(x, 41));
+} // _S1
+
+
+// -----------------------------------------------------------------------------
+FN_ uint64_t _G0(uint64_t x)
+{
+    return (_r(x, 1) ^ _r(x, 8) ^ (x >> 7));
+} // _G0
+
+
+// -----------------------------------------------------------------------------
+FN_ uint64_t _G1(uint64_t x)
+{
+    return (_r(x, 19) ^ _r(x, 61) ^ (x >> 6));
+} // _G1
+
+
+// -----------------------------------------------------------------------------
+static inline uint64_t _word(const uint8_t *c)
+{
+    uint64_t w = 0;
+
+    for (int i = 0; i < 8; i++) {
+        w = (w << 8) | c[i];
+    }
+
+    return w;
+} // _word
+
+
+// -----------------------------------------------------------------------------
+static void _addbits(sha512_context *ctx, uint64_t n)
+{
+    ctx->bits[0] += n;
+
+    if (ctx->bits[0] < n) {
+        ctx->bits[1]++;
+    }
+} // _addbits
+
+
+// -----------------------------------------------------------------------------
+// compress `blocks` consecutive 128 byte blocks of data into hash, the schedule
+// rolls in W[16] like in sha256.c
+static void _hash(uint64_t *hash, const uint8_t *data, size_t blocks)
+{
+    uint64_t a, b, c, d, e, f, g, h;
+    uint64_t t[2];
+    uint64_t W[16];
+
+    for (; blocks > 0; blocks--, data += 128) {
+        a = hash[0];
+        b = hash[1];
+        c = hash[2];
+        d = hash[3];
+        e = hash[4];
+        f = hash[5];
+        g = hash[6];
+        h = hash[7];
+
+        for (uint32_t i = 0; i < 80; i++) {
+            if (i < 16) {
+                W[i] = _word(&data[8 * i]);
+            } else {
+                W[i & 15] += _G1(W[(i - 2) & 15]) + W[(i - 7) & 15] +
+                             _G0(W[(i - 15) & 15]);
+            }
+
+            t[0] = h + _S1(e) + _Ch(e, f, g) + K[i] + W[i & 15];
+            t[1] = _S0(a) + _Ma(a, b, c);
+            h = g;
+            g = f;
+            f = e;
+            e = d + t[0];
+            d = c;
+            c = b;
+            b = a;
+            a = t[0] + t[1];
+        }
+
+        hash[0] += a;
+        hash[1] += b;
+        hash[2] += c;
+        hash[3] += d;
+        hash[4] += e;
+        hash[5] += f;
+        hash[6] += g;
+        hash[7] += h;
+    }
+} // _hash
+
+
+// -----------------------------------------------------------------------------
+void sha512_init(sha512_context *ctx)
+{
+    if (ctx != NULL) {
+        ctx->bits[0] = ctx->bits[1] = 0;
+        ctx->len = 0;
+        ctx->size = SHA512_SIZE_BYTES;
+        ctx->hash[0] = 0x6a09e667f3bcc908ULL;
+        ctx->hash[1] = 0xbb67ae8584caa73bULL;
+        ctx->hash[2] = 0x3c6ef372fe94f82bULL;
+        ctx->hash[3] = 0xa54ff53a5f1d36f1ULL;
+        ctx->hash[4] = 0x510e527fade682d1ULL;
+        ctx->hash[5] = 0x9b05688c2b3e6c1fULL;
+        ctx->hash[6] = 0x1f83d9abfb41bd6bULL;
+        ctx->hash[7] = 0x5be0cd19137e2179ULL;
+    }
+} // sha512_init
+
+
+// -----------------------------------------------------------------------------
+void sha512_256_init(sha512_context *ctx)
+{
+    if (ctx != NULL) {
+        ctx->bits[0] = ctx->bits[1] = 0;
+        ctx->len = 0;
+        ctx->size = SHA512_256_SIZE_BYTES;
+        ctx->hash[0] = 0x22312194fc2bf72cULL;
+        ctx->hash[1] = 0x9f555fa3c84c64c2ULL;
+        ctx->hash[2] = 0x2393b86b6f53b151ULL;
+        ctx->hash[3] = 0x963877195940eabdULL;
+        ctx->hash[4] = 0x96283ee2a88effe3ULL;
+        ctx->hash[5] = 0xbe5e1e2553863992ULL;
+        ctx->hash[6] = 0x2b0199fc2c85b8aaULL;
+        ctx->hash[7] = 0x0eb72ddc81c52ca2ULL;
+    }
+} // sha512_256_init
+
+
+// -----------------------------------------------------------------------------
+void sha512_hash(sha512_context *ctx, const void *data, size_t len)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    if ((ctx != NULL) && (bytes != NULL) && (ctx->len < sizeof(ctx->buf))) {
+        // top up a partially filled buffer first
+        if (ctx->len > 0) {
+            size_t n = sizeof(ctx->buf) - ctx->len;
+
+            if (n > len) {
+                n = len;
+            }
+
+            memcpy(&ctx->buf[ctx->len], bytes, n);
+            ctx->len += (uint32_t)n;
+            bytes += n;
+            len -= n;
+
+            if (ctx->len < sizeof(ctx->buf)) {
+                return;
+            }
+
+            _hash(ctx->hash, ctx->buf, 1);
+            _addbits(ctx, sizeof(ctx->buf) * 8);
+            ctx->len = 0;
+        }
+
+        // whole blocks straight from the caller's buffer
+        size_t blocks = len / sizeof(ctx->buf);
+
+        if (blocks > 0) {
+            _hash(ctx->hash, bytes, blocks);
+            _addbits(ctx, (uint64_t)blocks * sizeof(ctx->buf) * 8);
+            bytes += blocks * sizeof(ctx->buf);
+            len -= blocks * sizeof(ctx->buf);
+        }
+
+        // and keep the tail for later
+        memcpy(ctx->buf, bytes, len);
+        ctx->len = (uint32_t)len;
+    }
+} // sha512_hash
+
+
+// -----------------------------------------------------------------------------
+void sha512_done(sha512_context *ctx, uint8_t *hash)
+{
+    if (ctx != NULL) {
+        uint32_t j = ctx->len;
+
+        ctx->buf[j] = 0x80;
+        memset(&ctx->buf[j + 1], 0, sizeof(ctx->buf) - j - 1);
+
+        // the length takes the last 16 bytes
+        if (j > 111) {
+            _hash(ctx->hash, ctx->buf, 1);
+            memset(ctx->buf, 0, sizeof(ctx->buf));
+        }
+
+        _addbits(ctx, (uint64_t)ctx->len * 8);
+
+        for (int i = 0; i < 8; i++) {
+            ctx->buf[112 + i] = (uint8_t)(ctx->bits[1] >> (56 - 8 * i));
+            ctx->buf[120 + i] = (uint8_t)(ctx->bits[0] >> (56 - 8 * i));
+        }
+
+        _hash(ctx->hash, ctx->buf, 1);
+
+        if (hash != NULL) {
+            for (uint32_t i = 0; i < ctx->size; i++) {
+                hash[i] = (uint8_t)(ctx->hash[i / 8] >> (56 - 8 * (i % 8)));
+            }
+        }
+    }
+} // sha512_done
+
+
+// -----------------------------------------------------------------------------
+void sha512(const void *data, size_t len, uint8_t *hash)
+{
+    sha512_context ctx;
+
+    sha512_init(&ctx);
+    sha512_hash(&ctx, data, len);
+    sha512_done(&ctx, hash);
+} // sha512
+
+
+// -----------------------------------------------------------------------------
+void sha512_256(const void *data, size_t len, uint8_t *hash)
+{
+    sha512_context ctx;
+
+    sha512_256_init(&ctx);
+    sha512_hash(&ctx, data, len);
+    sha512_done(&ctx, hash);
+} // sha512_256
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,44 @@
+//
+//  SHA-512 and SHA-512/256 (FIPS 180-4), same shape as sha256.h
+//
+//  SHA-512 works on 64 bit words and 128 byte blocks, 80 rounds per block, so on
+//  64 bit cores it moves more bytes per round than SHA-256. SHA-512/256 is the
+//  same function with its own initial hash, cut to 32 bytes.
+//
+
+#ifndef SHA512_H_
+#define SHA512_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA512_SIZE_BYTES      (64)
+#define SHA512_256_SIZE_BYTES  (32)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct {
+    uint8_t  buf[128];
+    uint64_t hash[8];
+    uint64_t bits[2];
+    uint32_t len;
+    // bytes of digest sha512_done writes, 64 or 32 for SHA-512/256
+    uint32_t size;
+} sha512_context;
+
+void sha512_init(sha512_context *ctx);
+void sha512_256_init(sha512_context *ctx);
+void sha512_hash(sha512_context *ctx, const void *data, size_t len);
+void sha512_done(sha512_context *ctx, uint8_t *hash);
+
+void sha512(const void *data, size_t len, uint8_t *hash);
+void sha512_256(const void *data, size_t len, uint8_t *hash);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
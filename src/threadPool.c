@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "threadPool.h"
+
+// https://man7.org/linux/man-pages/man7/pthreads.7.html
+
+#define MAX_THREADS 64
+
+static pthread_once_t poolOnce = PTHREAD_ONCE_INIT;
+static size_t requestedThreads = 0;
+static size_t workerCount = 0;
+
+static pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t workReady = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t workDone = PTHREAD_COND_INITIALIZER;
+
+// only one job runs at a time, this serializes threadpoolFor callers
+static pthread_mutex_t jobLock = PTHREAD_MUTEX_INITIALIZER;
+
+// the current job, everything is protected by poolLock
+static void (*jobTask)(void *arg, size_t index);
+static void *jobArg;
+static size_t jobCount;
+static size_t jobNext;
+static size_t jobFinished;
+static size_t jobBusy;
+static unsigned long jobGeneration;
+
+// set in pool threads (and the caller while it helps) so nested calls run serially
+static _Thread_local int insidePool = 0;
+
+// take tasks of the current job until there are none left
+static void runTasks(void) {
+
+    pthread_mutex_lock(&poolLock);
+
+    while (jobNext < jobCount) {
+        size_t index = jobNext++;
+        void (*task)(void *arg, size_t index) = jobTask;
+        void *arg = jobArg;
+
+        pthread_mutex_unlock(&poolLock);
+        task(arg, index);
+        pthread_mutex_lock(&poolLock);
+
+        jobFinished++;
+    }
+
+    pthread_mutex_unlock(&poolLock);
+}
+
+static void *workerMain(void *unused) {
+    (void)unused;
+
+    insidePool = 1;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&poolLock);
+
+    for (;;) {
+        while (jobGeneration == seen) {
+            pthread_cond_wait(&workReady, &poolLock);
+        }
+
+        seen = jobGeneration;
+        jobBusy++;
+        pthread_mutex_unlock(&poolLock);
+
+        runTasks();
+
+        pthread_mutex_lock(&poolLock);
+        jobBusy--;
+
+        if (jobBusy == 0 && jobFinished == jobCount) {
+            pthread_cond_signal(&workDone);
+        }
+    }
+
+    return NULL;
+}
+
+static void startWorkers(void) {
+
+    size_t threads = requestedThreads;
+
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (size_t)cpus : 1;
+    }
+
+    if (threads > MAX_THREADS) {
+        threads = MAX_THREADS;
+    }
+
+    // the caller is one of the threads
+    for (size_t i = 0; i + 1 < threads; i++) {
+        pthread_t thread;
+
+        if (pthread_create(&thread, NULL, workerMain, NULL) != 0) {
+            fprintf(stderr, "Failed to start worker thread, continuing with %zu\n", workerCount);
+            break;
+        }
+
+        pthread_detach(thread);
+        workerCount++;
+    }
+}
+
+void threadpoolInit(size_t threads) {
+    requestedThreads = threads;
+
+    pthread_once(&poolOnce, startWorkers);
+}
+
+size_t threadpoolSize(void) {
+    pthread_once(&poolOnce, startWorkers);
+
+    return workerCount + 1;
+}
+
+void threadpoolFor(size_t count, void (*task)(void *arg, size_t index), void *arg) {
+
+    pthread_once(&poolOnce, startWorkers);
+
+    if (insidePool || workerCount == 0 || count < 2) {
+        for (size_t i = 0; i < count; i++) {
+            task(arg, i);
+        }
+
+        return;
+    }
+
+    pthread_mutex_lock(&jobLock);
+    pthread_mutex_lock(&poolLock);
+
+    jobTask = task;
+    jobArg = arg;
+    jobCount = count;
+    jobNext = 0;
+    jobFinished = 0;
+    jobGeneration++;
+
+    pthread_cond_broadcast(&workReady);
+    pthread_mutex_unlock(&poolLock);
+
+    // help instead of just waiting
+    insidePool = 1;
+    runTasks();
+    insidePool = 0;
+
+    // wait for the last tasks, and for every worker to leave this job before the
+    // next one can reuse the job variables
+    pthread_mutex_lock(&poolLock);
+
+    while (jobFinished < jobCount || jobBusy > 0) {
+        pthread_cond_wait(&workDone, &poolLock);
+    }
+
+    pthread_mutex_unlock(&poolLock);
+    pthread_mutex_unlock(&jobLock);
+}
@@ -0,0 +1,24 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stddef.h>
+
+/*
+    Fixed worker pool shared by the parallel paths (CBC decrypt, CTR, ...)
+
+    The workers are started on first use, one per CPU minus the calling thread,
+    which also takes tasks while it waits.
+*/
+
+// optional, choose the number of threads (caller included) before the first
+// threadpoolFor, 0 means one per CPU
+void threadpoolInit(size_t threads);
+
+// threads doing the work, caller included
+size_t threadpoolSize(void);
+
+// run task(arg, i) for every i in [0, count) and return once all are done
+// calls from inside a task run serially on that thread
+void threadpoolFor(size_t count, void (*task)(void *arg, size_t index), void *arg);
+
+#endif
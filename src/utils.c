@@ -95,33 +95,58 @@ void getInput(const char* prompt, char* buffer, size_t buffer_size) {
     fgets(buffer, buffer_size, stdin);
 }
 
-void genrandomdesKey(uint8_t *key) {
-    srand(time(NULL));
+// key bytes from the OS, rand() seeded with the time is only about 32 bits
+// that anyone who knows roughly when the key was made can try
+static int randomBytes(uint8_t *bytes, size_t length) {
 
-    for (int i = 0; i < 8; i++) {
-        key[i] = rand() % 256;
+    FILE *file = fopen("/dev/urandom", "rb");
+
+    if (!file) {
+        return EXIT_FAILURE;
     }
+
+    size_t count = fread(bytes, 1, length, file);
+
+    fclose(file);
+
+    return count == length ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-void genrandomIV(uint8_t *iv) {
-    for (int i = 0; i < 8; i++) {
-        iv[i] = rand() % 256;
+// only where there is no /dev/urandom, and said so
+static void weakrandomBytes(uint8_t *bytes, size_t length) {
+
+    static int seeded = 0;
+
+    fprintf(stderr, "No /dev/urandom, falling back to rand(), the output is weak\n");
+
+    // once, seeding again in the same second would give the IV the key's bytes
+    if (!seeded) {
+        srand(time(NULL));
+        seeded = 1;
     }
 
-    // or we can use /dev/urandom
-    // FILE *fptr = fopen("/dev/urandom", "rb");
-    // if (fptr == NULL) {
-    //     printf("Failed to open /dev/urandom\n");
-    //     exit(EXIT_FAILURE);
-    // }
+    for (size_t i = 0; i < length; i++) {
+        bytes[i] = rand() % 256;
+    }
+}
+
+void genrandomdesKey(uint8_t *key) {
+    if (randomBytes(key, 8) != EXIT_SUCCESS) {
+        weakrandomBytes(key, 8);
+    }
+}
 
-    // if (fread(iv, 1, 8, fptr) != 8) {
-    //     printf("Failed to read random bytes from /dev/urandom\n");
-    //     fclose(fptr);
-    //     exit(EXIT_FAILURE);
-    // }
+void genrandomdes3Key(uint8_t *key) {
+    // all 24 bytes at once, k1, k2 and k3 independent
+    if (randomBytes(key, 24) != EXIT_SUCCESS) {
+        weakrandomBytes(key, 24);
+    }
+}
 
-    // fclose(fptr);
+void genrandomIV(uint8_t *iv) {
+    if (randomBytes(iv, 8) != EXIT_SUCCESS) {
+        weakrandomBytes(iv, 8);
+    }
 }
 
 int hextoBytes(const char *hex_str, uint8_t *bytes, size_t bytesLength) {
@@ -142,12 +167,10 @@ int hextoBytes(const char *hex_str, uint8_t *bytes, size_t bytesLength) {
 
 void pkcs7Padding(uint8_t *out, const uint8_t *in, size_t length, size_t blocksize) {
 
+    // a whole block of padding when length is already a multiple, so the last
+    // byte always says how much to strip
     size_t pad = blocksize - (length % blocksize);
 
-    if (pad == blocksize) {
-        pad = 0;
-    }
-
     memcpy(out, in, length);
 
     for (size_t i = 0; i < pad; i++) {
@@ -15,8 +15,11 @@ void uint64toBytes(uint64_t value, uint8_t *bytes);
 void printHex(const uint8_t *data, size_t len);
 void getInput(const char* prompt, char* buffer, size_t buffer_size);
 void genrandomdesKey(uint8_t *key);
+// k1 || k2 || k3 for 3DES
+void genrandomdes3Key(uint8_t *key);
 void genrandomIV(uint8_t *iv);
 int hextoBytes(const char *hex_str, uint8_t *bytes, size_t bytesLength);
+// out gets length rounded up to the next multiple of blocksize (+1 to blocksize bytes)
 void pkcs7Padding(uint8_t *out, const uint8_t *in, size_t length, size_t blocksize);
 
 #endif
\ No newline at end of file